@@ -0,0 +1,63 @@
+#ifndef SPIRIT_BENCHMARK_SWEEP_HPP
+#define SPIRIT_BENCHMARK_SWEEP_HPP
+
+#include "celero/Celero.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+////////////////////////////////////////////////////////////
+// Problem space shared by the benchmarks: sizes 1, 10, ..., 10^7.
+//
+// Every sample processes about 10^6 elements,
+// small sizes are repeated for more iterations.
+//
+// Benchmarks of large objects (matrices, transformations) cycle through
+// a pool of at most maxPoolSize of them to keep memory bounded,
+// bulk operations on vectors use the whole size.
+////////////////////////////////////////////////////////////
+
+class SweepFixture : public celero::TestFixture
+{
+public:
+
+    static constexpr std::int64_t maxSize           = 10'000'000;
+    static constexpr std::int64_t elementsPerSample = 1'000'000;
+    static constexpr std::size_t maxPoolSize        = 1 << 16;
+
+    virtual std::vector<celero::TestFixture::ExperimentValue>
+    getExperimentValues() const override
+    {
+        std::vector<celero::TestFixture::ExperimentValue> problemSpace;
+        for (std::int64_t size = 1; size <= maxSize; size *= 10)
+        {
+            problemSpace.push_back({size, std::max<std::int64_t>(1, elementsPerSample / size)});
+        }
+
+        return problemSpace;
+    }
+
+    virtual void
+    setUp(const celero::TestFixture::ExperimentValue & experimentValue) override
+    {
+        size = static_cast<std::size_t>(experimentValue.Value);
+    }
+
+    std::size_t
+    poolSize() const
+    {
+        return std::min(size, maxPoolSize);
+    }
+
+    // index of the i-th element of a pool
+    std::size_t
+    pooled(std::size_t i) const
+    {
+        return i % poolSize();
+    }
+
+    std::size_t size = 0;
+};
+
+#endif // SPIRIT_BENCHMARK_SWEEP_HPP
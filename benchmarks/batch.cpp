@@ -0,0 +1,152 @@
+#include "Sweep.hpp"
+#include "SPIRIT/Math.hpp"
+
+#include <cmath>
+
+CELERO_MAIN
+
+////////////////////////////////////////////////////////////
+// sp::Batch arithmetic and math functions over arrays,
+// against the same loop written with scalars.
+//
+// The scalar loops may be auto-vectorized by the compiler,
+// except for the math functions: the benchmarks measure what
+// explicit batches bring over plain code.
+////////////////////////////////////////////////////////////
+
+
+class BatchFixture : public SweepFixture
+{
+public:
+
+    typedef sp::BatchF Batch;
+
+    virtual void
+    setUp(const celero::TestFixture::ExperimentValue & experimentValue) override
+    {
+        SweepFixture::setUp(experimentValue);
+
+        // padded to a whole number of batches
+        std::size_t padded = (size + Batch::size - 1) / Batch::size * Batch::size;
+
+        a.resize(padded);
+        b.resize(padded);
+        c.resize(padded);
+        res.resize(padded);
+
+        sp::RandList::Uni::randFloat(0.5f, 2.f, a);
+        sp::RandList::Uni::randFloat(0.5f, 2.f, b);
+        sp::RandList::Uni::randFloat(0.5f, 2.f, c);
+    }
+
+    virtual void
+    tearDown() override
+    {
+        a   = {};
+        b   = {};
+        c   = {};
+        res = {};
+    }
+
+    template <class Op>
+    void
+    scalarLoop(Op op)
+    {
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            res[i] = op(a[i], b[i], c[i]);
+        }
+
+        celero::DoNotOptimizeAway(res[0]);
+    }
+
+    template <class Op>
+    void
+    batchLoop(Op op)
+    {
+        for (std::size_t i = 0; i < size; i += Batch::size)
+        {
+            Batch x = Batch::loadAligned(&a[i]);
+            Batch y = Batch::loadAligned(&b[i]);
+            Batch z = Batch::loadAligned(&c[i]);
+            op(x, y, z).storeAligned(&res[i]);
+        }
+
+        celero::DoNotOptimizeAway(res[0]);
+    }
+
+    sp::details::AlignedVector<float> a;
+    sp::details::AlignedVector<float> b;
+    sp::details::AlignedVector<float> c;
+    sp::details::AlignedVector<float> res;
+};
+
+
+BASELINE_F(BatchArithmetic, Scalar, BatchFixture, 10, 0)
+{
+    scalarLoop([](float x, float y, float z) { return (x + y) * z - x / y; });
+}
+
+BENCHMARK_F(BatchArithmetic, Batch, BatchFixture, 10, 0)
+{
+    batchLoop([](const Batch & x, const Batch & y, const Batch & z) {
+        return (x + y) * z - x / y;
+    });
+}
+
+
+BASELINE_F(BatchFma, Scalar, BatchFixture, 10, 0)
+{
+    scalarLoop([](float x, float y, float z) { return std::fma(x, y, z); });
+}
+
+BENCHMARK_F(BatchFma, Batch, BatchFixture, 10, 0)
+{
+    batchLoop([](const Batch & x, const Batch & y, const Batch & z) {
+        return sp::fma(x, y, z);
+    });
+}
+
+
+BASELINE_F(BatchSqrt, Scalar, BatchFixture, 10, 0)
+{
+    scalarLoop([](float x, float, float) { return std::sqrt(x); });
+}
+
+BENCHMARK_F(BatchSqrt, Batch, BatchFixture, 10, 0)
+{
+    batchLoop([](const Batch & x, const Batch &, const Batch &) { return sp::sqrt(x); });
+}
+
+
+BASELINE_F(BatchSin, Scalar, BatchFixture, 10, 0)
+{
+    scalarLoop([](float x, float, float) { return std::sin(x); });
+}
+
+BENCHMARK_F(BatchSin, Batch, BatchFixture, 10, 0)
+{
+    batchLoop([](const Batch & x, const Batch &, const Batch &) { return sp::sin(x); });
+}
+
+
+BASELINE_F(BatchExp, Scalar, BatchFixture, 10, 0)
+{
+    scalarLoop([](float x, float, float) { return std::exp(x); });
+}
+
+BENCHMARK_F(BatchExp, Batch, BatchFixture, 10, 0)
+{
+    batchLoop([](const Batch & x, const Batch &, const Batch &) { return sp::exp(x); });
+}
+
+
+BASELINE_F(BatchLog, Scalar, BatchFixture, 10, 0)
+{
+    scalarLoop([](float x, float, float) { return std::log(x); });
+}
+
+BENCHMARK_F(BatchLog, Batch, BatchFixture, 10, 0)
+{
+    batchLoop([](const Batch & x, const Batch &, const Batch &) { return sp::log(x); });
+}
@@ -0,0 +1,189 @@
+#include "Sweep.hpp"
+#include "SPIRIT/Math.hpp"
+
+CELERO_MAIN
+
+////////////////////////////////////////////////////////////
+// Matrix operations of dimension 2 to 4, Eigen against the wrapper.
+//
+// Equal timings are expected, a difference means the wrapper
+// adds copies or breaks Eigen's fixed size specializations.
+////////////////////////////////////////////////////////////
+
+
+template <sp::Int32 dim>
+class MatrixFixture : public SweepFixture
+{
+public:
+
+    typedef Eigen::Matrix<float, dim, dim> EigenMatrix;
+    typedef Eigen::Matrix<float, dim, 1> EigenVector;
+
+    virtual void
+    setUp(const celero::TestFixture::ExperimentValue & experimentValue) override
+    {
+        SweepFixture::setUp(experimentValue);
+
+        sp::Random::seed(0);
+
+        eigMatrices.resize(poolSize());
+        eigVectors.resize(poolSize());
+        matrices.resize(poolSize());
+        vectors.resize(poolSize());
+
+        std::array<float, dim * dim> dat;
+        for (std::size_t i = 0; i < poolSize(); ++i)
+        {
+            sp::RandList::Uni::randFloat(-1.f, 1.f, dat);
+
+            for (sp::Int32 r = 0; r < dim; ++r)
+            {
+                // diagonally dominant, always invertible
+                dat[r * dim + r] += dim;
+
+                eigVectors[i](r) = dat[r];
+                vectors[i][r]    = dat[r];
+                for (sp::Int32 c = 0; c < dim; ++c)
+                {
+                    eigMatrices[i](r, c) = dat[r * dim + c];
+                    matrices[i](r, c)    = dat[r * dim + c];
+                }
+            }
+        }
+    }
+
+    void
+    eigenInverse()
+    {
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            EigenMatrix inv = eigMatrices[pooled(i)].inverse();
+            celero::DoNotOptimizeAway(inv);
+        }
+    }
+
+    void
+    spiritInverse()
+    {
+        bool wasInversed;
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            sp::Matrix<float, dim, dim> inv = matrices[pooled(i)].inversed(wasInversed);
+            celero::DoNotOptimizeAway(inv);
+        }
+    }
+
+    void
+    eigenSolve()
+    {
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            EigenVector x = eigMatrices[pooled(i)].householderQr().solve(eigVectors[pooled(i)]);
+            celero::DoNotOptimizeAway(x);
+        }
+    }
+
+    void
+    spiritSolve()
+    {
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            sp::Vector<float, dim> x = matrices[pooled(i)].solve(vectors[pooled(i)]);
+            celero::DoNotOptimizeAway(x);
+        }
+    }
+
+    void
+    eigenDeterminant()
+    {
+        float sum = 0;
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            sum += eigMatrices[pooled(i)].determinant();
+        }
+
+        celero::DoNotOptimizeAway(sum);
+    }
+
+    void
+    spiritDeterminant()
+    {
+        float sum = 0;
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            sum += matrices[pooled(i)].determinant();
+        }
+
+        celero::DoNotOptimizeAway(sum);
+    }
+
+    void
+    eigenNormalize()
+    {
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            EigenVector n = eigVectors[pooled(i)].normalized();
+            celero::DoNotOptimizeAway(n);
+        }
+    }
+
+    void
+    spiritNormalize()
+    {
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            sp::Vector<float, dim> n = vectors[pooled(i)].normalized();
+            celero::DoNotOptimizeAway(n);
+        }
+    }
+
+    std::vector<EigenMatrix> eigMatrices;
+    std::vector<EigenVector> eigVectors;
+    std::vector<sp::Matrix<float, dim, dim>> matrices;
+    std::vector<sp::Vector<float, dim>> vectors;
+};
+
+// the fixture must be a single macro argument
+typedef MatrixFixture<2> Matrix2Fixture;
+typedef MatrixFixture<3> Matrix3Fixture;
+typedef MatrixFixture<4> Matrix4Fixture;
+
+
+BASELINE_F(Inverse2, Eigen, Matrix2Fixture, 10, 0) { eigenInverse(); }
+BENCHMARK_F(Inverse2, Spirit, Matrix2Fixture, 10, 0) { spiritInverse(); }
+
+BASELINE_F(Inverse3, Eigen, Matrix3Fixture, 10, 0) { eigenInverse(); }
+BENCHMARK_F(Inverse3, Spirit, Matrix3Fixture, 10, 0) { spiritInverse(); }
+
+BASELINE_F(Inverse4, Eigen, Matrix4Fixture, 10, 0) { eigenInverse(); }
+BENCHMARK_F(Inverse4, Spirit, Matrix4Fixture, 10, 0) { spiritInverse(); }
+
+
+BASELINE_F(Solve2, Eigen, Matrix2Fixture, 10, 0) { eigenSolve(); }
+BENCHMARK_F(Solve2, Spirit, Matrix2Fixture, 10, 0) { spiritSolve(); }
+
+BASELINE_F(Solve3, Eigen, Matrix3Fixture, 10, 0) { eigenSolve(); }
+BENCHMARK_F(Solve3, Spirit, Matrix3Fixture, 10, 0) { spiritSolve(); }
+
+BASELINE_F(Solve4, Eigen, Matrix4Fixture, 10, 0) { eigenSolve(); }
+BENCHMARK_F(Solve4, Spirit, Matrix4Fixture, 10, 0) { spiritSolve(); }
+
+
+BASELINE_F(Determinant2, Eigen, Matrix2Fixture, 10, 0) { eigenDeterminant(); }
+BENCHMARK_F(Determinant2, Spirit, Matrix2Fixture, 10, 0) { spiritDeterminant(); }
+
+BASELINE_F(Determinant3, Eigen, Matrix3Fixture, 10, 0) { eigenDeterminant(); }
+BENCHMARK_F(Determinant3, Spirit, Matrix3Fixture, 10, 0) { spiritDeterminant(); }
+
+BASELINE_F(Determinant4, Eigen, Matrix4Fixture, 10, 0) { eigenDeterminant(); }
+BENCHMARK_F(Determinant4, Spirit, Matrix4Fixture, 10, 0) { spiritDeterminant(); }
+
+
+BASELINE_F(Normalize2, Eigen, Matrix2Fixture, 10, 0) { eigenNormalize(); }
+BENCHMARK_F(Normalize2, Spirit, Matrix2Fixture, 10, 0) { spiritNormalize(); }
+
+BASELINE_F(Normalize3, Eigen, Matrix3Fixture, 10, 0) { eigenNormalize(); }
+BENCHMARK_F(Normalize3, Spirit, Matrix3Fixture, 10, 0) { spiritNormalize(); }
+
+BASELINE_F(Normalize4, Eigen, Matrix4Fixture, 10, 0) { eigenNormalize(); }
+BENCHMARK_F(Normalize4, Spirit, Matrix4Fixture, 10, 0) { spiritNormalize(); }
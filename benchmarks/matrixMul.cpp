@@ -158,3 +158,27 @@ BENCHMARK_F(MatrixMul, SpiritSwitch, Fixture, 100, 0)
 
     celero::DoNotOptimizeAway(res);
 }
+
+BENCHMARK_F(MatrixMul, SpiritLazy, Fixture, 100, 0)
+{
+    sp::Mat4 res;
+
+    switch (nMatrices)
+    {
+        case 2: res = sp::lazy(matrices[0]) * matrices[1]; break;
+        case 3: res = sp::lazy(matrices[0]) * matrices[1] * matrices[2]; break;
+        case 4:
+            res = sp::lazy(matrices[0]) * matrices[1] * matrices[2]
+                  * matrices[3];
+            break;
+        case 5:
+            res = sp::lazy(matrices[0]) * matrices[1] * matrices[2]
+                  * matrices[3] * matrices[4];
+            break;
+        case 6:
+            res = sp::lazy(matrices[0]) * matrices[1] * matrices[2]
+                  * matrices[3] * matrices[4] * matrices[5];
+    }
+
+    celero::DoNotOptimizeAway(res);
+}
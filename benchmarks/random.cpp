@@ -0,0 +1,421 @@
+#include "Sweep.hpp"
+#include "SPIRIT/Math.hpp"
+
+CELERO_MAIN
+
+////////////////////////////////////////////////////////////
+// Every distribution of sp::Random (one value per call)
+// against the bulk equivalent of sp::RandList.
+////////////////////////////////////////////////////////////
+
+
+class RandomFixture : public SweepFixture
+{
+public:
+
+    virtual void
+    setUp(const celero::TestFixture::ExperimentValue & experimentValue) override
+    {
+        SweepFixture::setUp(experimentValue);
+
+        floats.resize(size);
+        doubles.resize(size);
+        ints.resize(size);
+        uints.resize(size);
+        coins.resize(size);
+        words.resize(size);
+        points.resize(size);
+        vectors.resize(size);
+        rotations.resize(size);
+
+        weights.resize(16);
+        sp::RandList::Uni::randFloat(0.0, 1.0, weights);
+        sampler = sp::WeightedSampler<>{weights};
+    }
+
+    std::vector<float> floats;
+    std::vector<double> doubles;
+    std::vector<sp::Int32> ints;
+    std::vector<sp::Uint32> uints;
+    std::vector<sp::Uint8> coins;
+    std::vector<sp::Uint64> words;
+    std::vector<sp::Vec2> points;
+    std::vector<sp::Vec3> vectors;
+    std::vector<sp::Quat> rotations;
+
+    std::vector<double> weights;
+    sp::WeightedSampler<> sampler;
+};
+
+
+BASELINE_F(UniformFloat, Scalar, RandomFixture, 10, 0)
+{
+    for (float & x : floats)
+    {
+        x = sp::Random::Uni::randFloat(0.f, 1.f);
+    }
+
+    celero::DoNotOptimizeAway(floats.back());
+}
+
+BENCHMARK_F(UniformFloat, Bulk, RandomFixture, 10, 0)
+{
+    sp::RandList::Uni::randFloat(0.f, 1.f, floats);
+    celero::DoNotOptimizeAway(floats.back());
+}
+
+
+BASELINE_F(UniformDouble, Scalar, RandomFixture, 10, 0)
+{
+    for (double & x : doubles)
+    {
+        x = sp::Random::Uni::randFloat(0.0, 1.0);
+    }
+
+    celero::DoNotOptimizeAway(doubles.back());
+}
+
+BENCHMARK_F(UniformDouble, Bulk, RandomFixture, 10, 0)
+{
+    sp::RandList::Uni::randFloat(0.0, 1.0, doubles);
+    celero::DoNotOptimizeAway(doubles.back());
+}
+
+
+BASELINE_F(UniformInt, Scalar, RandomFixture, 10, 0)
+{
+    for (sp::Int32 & x : ints)
+    {
+        x = sp::Random::Uni::randInt(-100, 100);
+    }
+
+    celero::DoNotOptimizeAway(ints.back());
+}
+
+BENCHMARK_F(UniformInt, Bulk, RandomFixture, 10, 0)
+{
+    sp::RandList::Uni::randInt(-100, 100, ints);
+    celero::DoNotOptimizeAway(ints.back());
+}
+
+
+// Random indices, std::uniform_int_distribution against Lemire's method
+BASELINE_F(Choose, StdDistribution, RandomFixture, 10, 0)
+{
+    std::uniform_int_distribution<sp::Uint32> dist{0, 999'999};
+    for (sp::Uint32 & u : uints)
+    {
+        u = dist(sp::Random::engine());
+    }
+
+    celero::DoNotOptimizeAway(uints.back());
+}
+
+BENCHMARK_F(Choose, Scalar, RandomFixture, 10, 0)
+{
+    for (sp::Uint32 & u : uints)
+    {
+        u = sp::Random::choose(1'000'000u);
+    }
+
+    celero::DoNotOptimizeAway(uints.back());
+}
+
+BENCHMARK_F(Choose, ScalarPowerOfTwo, RandomFixture, 10, 0)
+{
+    for (sp::Uint32 & u : uints)
+    {
+        u = sp::Random::choose(1u << 20);
+    }
+
+    celero::DoNotOptimizeAway(uints.back());
+}
+
+BENCHMARK_F(Choose, Bulk, RandomFixture, 10, 0)
+{
+    sp::RandList::choose(1'000'000u, uints);
+    celero::DoNotOptimizeAway(uints.back());
+}
+
+BENCHMARK_F(Choose, BulkPowerOfTwo, RandomFixture, 10, 0)
+{
+    sp::RandList::choose(1u << 20, uints);
+    celero::DoNotOptimizeAway(uints.back());
+}
+
+BASELINE_F(GaussFloat, Scalar, RandomFixture, 10, 0)
+{
+    for (float & x : floats)
+    {
+        x = sp::Random::Gauss::randFloat(0.f, 1.f);
+    }
+
+    celero::DoNotOptimizeAway(floats.back());
+}
+
+BENCHMARK_F(GaussFloat, Bulk, RandomFixture, 10, 0)
+{
+    sp::RandList::Gauss::randFloat(0.f, 1.f, floats);
+    celero::DoNotOptimizeAway(floats.back());
+}
+
+
+BASELINE_F(GaussInt, Scalar, RandomFixture, 10, 0)
+{
+    for (sp::Int32 & x : ints)
+    {
+        x = sp::Random::Gauss::randInt(0, 10);
+    }
+
+    celero::DoNotOptimizeAway(ints.back());
+}
+
+BENCHMARK_F(GaussInt, Bulk, RandomFixture, 10, 0)
+{
+    sp::RandList::Gauss::randInt(0, 10, ints);
+    celero::DoNotOptimizeAway(ints.back());
+}
+
+
+BASELINE_F(Coin, Scalar, RandomFixture, 10, 0)
+{
+    for (sp::Uint8 & x : coins)
+    {
+        x = sp::Random::coin(0.3);
+    }
+
+    celero::DoNotOptimizeAway(coins.back());
+}
+
+BENCHMARK_F(Coin, Bulk, RandomFixture, 10, 0)
+{
+    sp::RandList::coin<sp::Uint8>(coins, 0.3);
+    celero::DoNotOptimizeAway(coins.back());
+}
+
+
+// Random::Weighted builds its distribution on every call
+BASELINE_F(Weighted, Scalar, RandomFixture, 10, 0)
+{
+    for (sp::Uint32 & x : uints)
+    {
+        x = sp::Random::Weighted::randInt(weights);
+    }
+
+    celero::DoNotOptimizeAway(uints.back());
+}
+
+BENCHMARK_F(Weighted, Bulk, RandomFixture, 10, 0)
+{
+    sp::RandList::Weighted::randInt(weights, uints);
+    celero::DoNotOptimizeAway(uints.back());
+}
+
+BENCHMARK_F(Weighted, Sampler, RandomFixture, 10, 0)
+{
+    for (sp::Uint32 & x : uints)
+    {
+        x = sampler();
+    }
+
+    celero::DoNotOptimizeAway(uints.back());
+}
+
+BENCHMARK_F(Weighted, SamplerBulk, RandomFixture, 10, 0)
+{
+    sampler.sample(uints);
+    celero::DoNotOptimizeAway(uints.back());
+}
+
+
+// raw 64 bits outputs of each engine
+template <class Engine>
+void
+drawWords(Engine & engine, std::vector<sp::Uint64> & words)
+{
+    for (sp::Uint64 & word : words)
+    {
+        word = engine();
+    }
+
+    celero::DoNotOptimizeAway(words.back());
+}
+
+BASELINE_F(Engine, Philox, RandomFixture, 10, 0)
+{
+    drawWords(sp::Random::engine(), words);
+}
+
+BENCHMARK_F(Engine, Xoshiro256, RandomFixture, 10, 0)
+{
+    drawWords(sp::BasicRandom<sp::Xoshiro256>::engine(), words);
+}
+
+BENCHMARK_F(Engine, Pcg64, RandomFixture, 10, 0)
+{
+    drawWords(sp::BasicRandom<sp::Pcg64>::engine(), words);
+}
+
+BENCHMARK_F(Engine, SplitMix64, RandomFixture, 10, 0)
+{
+    drawWords(sp::BasicRandom<sp::SplitMix64>::engine(), words);
+}
+
+BENCHMARK_F(Engine, Mt19937, RandomFixture, 10, 0)
+{
+    static thread_local std::mt19937_64 engine{};
+    drawWords(engine, words);
+}
+
+
+// Philox is vectorized in bulk fills, other engines are drawn one word at a time
+BASELINE_F(EngineBulk, Philox, RandomFixture, 10, 0)
+{
+    sp::RandList::Uni::randFloat(0.f, 1.f, floats);
+    celero::DoNotOptimizeAway(floats.back());
+}
+
+BENCHMARK_F(EngineBulk, Xoshiro256, RandomFixture, 10, 0)
+{
+    sp::BasicRandList<sp::Xoshiro256>::Uni::randFloat(0.f, 1.f, floats);
+    celero::DoNotOptimizeAway(floats.back());
+}
+
+BENCHMARK_F(EngineBulk, Pcg64, RandomFixture, 10, 0)
+{
+    sp::BasicRandList<sp::Pcg64>::Uni::randFloat(0.f, 1.f, floats);
+    celero::DoNotOptimizeAway(floats.back());
+}
+
+
+// 2D samples, pseudo-random against the low-discrepancy sequences
+BASELINE_F(QuasiRandom, Uniform, RandomFixture, 10, 0)
+{
+    sp::RandList::random(&points[0][0], &points[0][0] + 2 * size);
+    celero::DoNotOptimizeAway(points.back());
+}
+
+BENCHMARK_F(QuasiRandom, Sobol, RandomFixture, 10, 0)
+{
+    sp::SobolSequence<2> sobol{};
+    sp::RandList::quasiRandom(sobol, points);
+    celero::DoNotOptimizeAway(points.back());
+}
+
+BENCHMARK_F(QuasiRandom, SobolOwen, RandomFixture, 10, 0)
+{
+    sp::SobolSequence<2> sobol{sp::Scrambling::Owen, 1};
+    sp::RandList::quasiRandom(sobol, points);
+    celero::DoNotOptimizeAway(points.back());
+}
+
+BENCHMARK_F(QuasiRandom, Halton, RandomFixture, 10, 0)
+{
+    sp::HaltonSequence<2> halton{};
+    sp::RandList::quasiRandom(halton, points);
+    celero::DoNotOptimizeAway(points.back());
+}
+
+BENCHMARK_F(QuasiRandom, R2, RandomFixture, 10, 0)
+{
+    sp::R2Sequence<2> r2{};
+    sp::RandList::quasiRandom(r2, points);
+    celero::DoNotOptimizeAway(points.back());
+}
+
+
+// Shapes composed from scalar draws against the rejection-free bulk mappings
+BASELINE_F(Sphere, Scalar, RandomFixture, 10, 0)
+{
+    for (sp::Vec3 & v : vectors)
+    {
+        v = sp::Vec3{
+            sp::Random::Gauss::randFloat(0.f, 1.f),
+            sp::Random::Gauss::randFloat(0.f, 1.f),
+            sp::Random::Gauss::randFloat(0.f, 1.f)};
+        v.normalize();
+    }
+
+    celero::DoNotOptimizeAway(vectors.back());
+}
+
+BENCHMARK_F(Sphere, Bulk, RandomFixture, 10, 0)
+{
+    sp::RandList::onSphere(vectors);
+    celero::DoNotOptimizeAway(vectors.back());
+}
+
+BASELINE_F(Ball, Scalar, RandomFixture, 10, 0)
+{
+    for (sp::Vec3 & v : vectors)
+    {
+        do
+        {
+            v = sp::Vec3{
+                sp::Random::Uni::randFloat(-1.f, 1.f),
+                sp::Random::Uni::randFloat(-1.f, 1.f),
+                sp::Random::Uni::randFloat(-1.f, 1.f)};
+        } while (v.squaredNorm() > 1);
+    }
+
+    celero::DoNotOptimizeAway(vectors.back());
+}
+
+BENCHMARK_F(Ball, Bulk, RandomFixture, 10, 0)
+{
+    sp::RandList::inBall(vectors);
+    celero::DoNotOptimizeAway(vectors.back());
+}
+
+BASELINE_F(Rotation, Scalar, RandomFixture, 10, 0)
+{
+    for (sp::Quat & q : rotations)
+    {
+        q = sp::Quat{
+            sp::Random::Gauss::randFloat(0.f, 1.f),
+            sp::Random::Gauss::randFloat(0.f, 1.f),
+            sp::Random::Gauss::randFloat(0.f, 1.f),
+            sp::Random::Gauss::randFloat(0.f, 1.f)};
+        q.normalize();
+    }
+
+    celero::DoNotOptimizeAway(rotations.back());
+}
+
+BENCHMARK_F(Rotation, Bulk, RandomFixture, 10, 0)
+{
+    sp::RandList::rotation(rotations);
+    celero::DoNotOptimizeAway(rotations.back());
+}
+
+
+// Shuffles, std::shuffle against MergeShuffle
+BASELINE_F(Shuffle, StdShuffle, RandomFixture, 10, 0)
+{
+    std::shuffle(uints.begin(), uints.end(), sp::Random::engine());
+    celero::DoNotOptimizeAway(uints.back());
+}
+
+BENCHMARK_F(Shuffle, MergeShuffle, RandomFixture, 10, 0)
+{
+    sp::RandList::shuffle(uints);
+    celero::DoNotOptimizeAway(uints.back());
+}
+
+BENCHMARK_F(Shuffle, MergeShuffleParallel, RandomFixture, 10, 0)
+{
+    sp::RandList::shuffle(uints, sp::Execution::Parallel);
+    celero::DoNotOptimizeAway(uints.back());
+}
+
+BENCHMARK_F(Shuffle, Permutation, RandomFixture, 10, 0)
+{
+    sp::RandList::permutation(uints);
+    celero::DoNotOptimizeAway(uints.back());
+}
+
+BENCHMARK_F(Shuffle, PermutationParallel, RandomFixture, 10, 0)
+{
+    sp::RandList::permutation(uints, sp::Execution::Parallel);
+    celero::DoNotOptimizeAway(uints.back());
+}
@@ -0,0 +1,255 @@
+"""
+Benchmark regression gate.
+
+Runs the Celero benchmark executables and either records their results as
+the baseline of the current commit, or compares them with the baseline of
+the closest ancestor that has one.
+
+Baselines are stored per commit in <baselines>/<commit sha>/<benchmark>.csv,
+results of a working tree with uncommitted changes are stored under
+<commit sha>-dirty and are never picked as a baseline automatically.
+
+An experiment (group, experiment, problem space) regresses when it is slower
+than its baseline by more than --threshold percent and the slowdown is
+significant: Welch's statistic, computed from the mean and variance columns
+of both runs, must be above --min-z.
+
+usage:
+    regression.py record  --baselines DIR executables...
+    regression.py compare --baselines DIR [--baseline REF] [--threshold PCT]
+                          [--min-z Z] [--results DIR] executables...
+"""
+
+import argparse
+import csv
+import math
+import os
+import subprocess
+import sys
+
+
+# Celero's columns, times are per sample in microseconds
+GROUP = "Group"
+EXPERIMENT = "Experiment"
+PROBLEM_SPACE = "Problem Space"
+SAMPLES = "Samples"
+ITERATIONS = "Iterations"
+MEAN = "T Mean (us)"
+VARIANCE = "T Variance"
+Z_SCORE = "T Z Score"
+
+# samples whose fastest run is this many deviations below the mean are noisy
+NOISY_Z_SCORE = 3.0
+
+
+class Measure:
+    def __init__(self, row):
+        self.samples = int(row[SAMPLES])
+        iterations = int(row[ITERATIONS])
+
+        # per iteration, so runs with different iteration counts compare
+        self.mean = float(row[MEAN]) / iterations
+        self.variance = float(row[VARIANCE]) / iterations**2
+        self.zScore = float(row[Z_SCORE])
+
+        if not math.isfinite(self.variance):
+            self.variance = 0.0
+        if not math.isfinite(self.zScore):
+            self.zScore = 0.0
+
+    def isNoisy(self):
+        return self.zScore > NOISY_Z_SCORE
+
+
+def git(*args):
+    return subprocess.run(
+        ["git", *args],
+        cwd=os.path.dirname(os.path.abspath(__file__)),
+        check=True,
+        capture_output=True,
+        text=True,
+    ).stdout.strip()
+
+
+def currentCommit():
+    sha = git("rev-parse", "HEAD")
+    if git("status", "--porcelain", "--untracked-files=no"):
+        sha += "-dirty"
+    return sha
+
+
+def findBaseline(baselines, ref):
+    """Baseline directory of ref, or of its closest ancestor that has one"""
+    if ref is not None:
+        sha = git("rev-parse", ref)
+        if not os.path.isdir(os.path.join(baselines, sha)):
+            sys.exit("No baseline recorded for {} ({})".format(ref, sha))
+        return sha
+
+    # HEAD itself is skipped when clean, its baseline would compare it with itself
+    head = git("rev-parse", "HEAD")
+    for sha in git("rev-list", "HEAD").splitlines():
+        if sha == head and not currentCommit().endswith("-dirty"):
+            continue
+        if os.path.isdir(os.path.join(baselines, sha)):
+            return sha
+
+    sys.exit(
+        "No baseline found in {} for HEAD or its ancestors, "
+        "record one first".format(baselines)
+    )
+
+
+def runBenchmarks(executables, outDir):
+    os.makedirs(outDir, exist_ok=True)
+    for exe in executables:
+        name = os.path.splitext(os.path.basename(exe))[0]
+        table = os.path.join(outDir, name + ".csv")
+        print("Running {}".format(name), flush=True)
+        subprocess.run([exe, "-t", table], check=True, stdout=subprocess.DEVNULL)
+
+
+def readResults(directory):
+    results = {}
+    for file in sorted(os.listdir(directory)):
+        if not file.endswith(".csv"):
+            continue
+
+        benchmark = os.path.splitext(file)[0]
+        with open(os.path.join(directory, file), newline="") as table:
+            for row in csv.DictReader(table):
+                key = (benchmark, row[GROUP], row[EXPERIMENT], row[PROBLEM_SPACE])
+                results[key] = Measure(row)
+
+    return results
+
+
+def welch(baseline, current):
+    """Welch's statistic of current being slower than baseline"""
+    error = math.sqrt(
+        baseline.variance / baseline.samples + current.variance / current.samples
+    )
+    diff = current.mean - baseline.mean
+    if error == 0:
+        return math.copysign(math.inf, diff) if diff != 0 else 0.0
+    return diff / error
+
+
+def formatTable(header, rows):
+    widths = [max(len(str(cell)) for cell in column) for column in zip(header, *rows)]
+    lines = [
+        "  ".join(str(cell).ljust(width) for cell, width in zip(line, widths)).rstrip()
+        for line in [header, *rows]
+    ]
+    lines.insert(1, "  ".join("-" * width for width in widths))
+    return "\n".join(lines)
+
+
+def compare(baselineResults, results, threshold, minZ):
+    """Prints the report, returns the number of regressions"""
+    header = ["Benchmark", "Group", "Experiment", "Size",
+              "Baseline (us)", "Current (us)", "Change", "Welch", "Note"]
+    regressions = []
+    improvements = []
+    noisy = 0
+
+    for key, current in sorted(results.items()):
+        baseline = baselineResults.get(key)
+        if baseline is None:
+            continue
+
+        change = 100.0 * (current.mean - baseline.mean) / baseline.mean
+        z = welch(baseline, current)
+
+        note = ""
+        if baseline.isNoisy() or current.isNoisy():
+            note = "noisy"
+            noisy += 1
+
+        row = [*key,
+               "{:.4g}".format(baseline.mean),
+               "{:.4g}".format(current.mean),
+               "{:+.1f}%".format(change),
+               "{:.1f}".format(z),
+               note]
+
+        if change > threshold and z > minZ:
+            regressions.append(row)
+        elif change < -threshold and z < -minZ:
+            improvements.append(row)
+
+    missing = sorted(set(baselineResults) - set(results))
+    added = sorted(set(results) - set(baselineResults))
+
+    print()
+    print("Compared {} experiments (threshold {}%, min Welch statistic {})".format(
+        len(results) - len(added), threshold, minZ))
+
+    if improvements:
+        print("\nImprovements:\n")
+        print(formatTable(header, improvements))
+
+    if regressions:
+        print("\nRegressions:\n")
+        print(formatTable(header, regressions))
+
+    if noisy:
+        print("\n{} experiments had noisy samples (Z score above {}), "
+              "rerun on a quiet machine if they regressed.".format(noisy, NOISY_Z_SCORE))
+    if missing:
+        print("\n{} experiments of the baseline were not run:".format(len(missing)))
+        for key in missing:
+            print("    " + ".".join(key))
+    if added:
+        print("\n{} experiments have no baseline yet.".format(len(added)))
+
+    print()
+    return len(regressions)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("command", choices=["record", "compare"])
+    parser.add_argument("executables", nargs="+")
+    parser.add_argument("--baselines", required=True,
+                        help="directory holding a subdirectory per commit")
+    parser.add_argument("--baseline", default=None,
+                        help="commit to compare with, defaults to the closest "
+                             "ancestor with a baseline")
+    parser.add_argument("--threshold", type=float, default=5.0,
+                        help="slowdown in percent above which an experiment regresses")
+    parser.add_argument("--min-z", type=float, default=3.0,
+                        help="Welch's statistic above which a slowdown is significant")
+    parser.add_argument("--results", default=None,
+                        help="where to write the results of a comparison run")
+    args = parser.parse_args()
+
+    if args.command == "record":
+        outDir = os.path.join(args.baselines, currentCommit())
+        runBenchmarks(args.executables, outDir)
+        print("Recorded baseline in {}".format(outDir))
+        return 0
+
+    baseline = findBaseline(args.baselines, args.baseline)
+    outDir = args.results or os.path.join(args.baselines, "latest")
+    runBenchmarks(args.executables, outDir)
+
+    print("\nBaseline: {}".format(baseline))
+    nRegressions = compare(
+        readResults(os.path.join(args.baselines, baseline)),
+        readResults(outDir),
+        args.threshold,
+        args.min_z,
+    )
+
+    if nRegressions:
+        print("FAILED: {} experiments regressed".format(nRegressions))
+        return 1
+
+    print("PASSED: no regressions")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
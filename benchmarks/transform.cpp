@@ -0,0 +1,221 @@
+#include "Sweep.hpp"
+#include "SPIRIT/Math.hpp"
+
+CELERO_MAIN
+
+////////////////////////////////////////////////////////////
+// Composition and inversion of the 3D transformations
+// (Affine, Compact, TRS and Quaternion rotations)
+// and their bulk application to points.
+////////////////////////////////////////////////////////////
+
+
+class TransformFixture : public SweepFixture
+{
+public:
+
+    virtual void
+    setUp(const celero::TestFixture::ExperimentValue & experimentValue) override
+    {
+        SweepFixture::setUp(experimentValue);
+
+        sp::Random::seed(0);
+
+        transforms.resize(poolSize());
+        matrices.resize(poolSize());
+        isometries.resize(poolSize());
+        uniforms.resize(poolSize());
+        compacts.resize(poolSize());
+        trs.resize(poolSize());
+        rotations.resize(poolSize());
+        for (std::size_t i = 0; i < poolSize(); ++i)
+        {
+            sp::Vec3 offset = randomVector();
+            sp::Vec3 axis   = randomVector();
+            float angle     = sp::Random::Uni::randFloat(-3.f, 3.f);
+            float scale     = sp::Random::Uni::randFloat(0.5f, 2.f);
+
+            rotations[i] = sp::Quat{angle, axis.normalized()};
+
+            isometries[i].translate(offset);
+            isometries[i].rotate(rotations[i]);
+
+            uniforms[i] = isometries[i];
+            uniforms[i].scale(scale);
+
+            transforms[i] = uniforms[i];
+            transforms[i].scale(sp::Vec3{1.f, scale, 2.f});
+
+            // same coefficients, but of unknown class
+            matrices[i] = sp::Transform3D{transforms[i].toMatrix()};
+
+            compacts[i] = transforms[i];
+            trs[i]      = sp::TRSTransform{offset, rotations[i], sp::Vec3{scale, scale, scale}};
+        }
+
+        points.resize(size);
+        for (sp::Vec3 & point : points)
+        {
+            point = randomVector();
+        }
+
+        transformed.resize(size);
+        stream = sp::Vec3Stream{points.begin(), points.end()};
+    }
+
+    virtual void
+    tearDown() override
+    {
+        points      = {};
+        transformed = {};
+        stream      = {};
+    }
+
+    static sp::Vec3
+    randomVector()
+    {
+        return sp::Vec3{
+            sp::Random::Uni::randFloat(-10.f, 10.f),
+            sp::Random::Uni::randFloat(-10.f, 10.f),
+            sp::Random::Uni::randFloat(-10.f, 10.f)};
+    }
+
+    std::vector<sp::Transform3D> transforms; // non uniform scaling
+    std::vector<sp::Transform3D> matrices;   // same as transforms, built from matrices
+    std::vector<sp::Transform3D> isometries;
+    std::vector<sp::Transform3D> uniforms;
+    std::vector<sp::CompactTransform3D> compacts;
+    std::vector<sp::TRSTransform> trs;
+    std::vector<sp::Quat> rotations;
+
+    std::vector<sp::Vec3> points;
+    std::vector<sp::Vec3> transformed;
+    sp::Vec3Stream stream;
+};
+
+
+// products of pairs of the pool, chaining them would overflow the scalings
+BASELINE_F(TransformCompose, Affine, TransformFixture, 10, 0)
+{
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        sp::Transform3D res = transforms[pooled(i)] * transforms[pooled(i + 1)];
+        celero::DoNotOptimizeAway(res);
+    }
+}
+
+BENCHMARK_F(TransformCompose, Compact, TransformFixture, 10, 0)
+{
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        sp::CompactTransform3D res = compacts[pooled(i)] * compacts[pooled(i + 1)];
+        celero::DoNotOptimizeAway(res);
+    }
+}
+
+BENCHMARK_F(TransformCompose, TRS, TransformFixture, 10, 0)
+{
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        sp::TRSTransform res = trs[pooled(i)] * trs[pooled(i + 1)];
+        celero::DoNotOptimizeAway(res);
+    }
+}
+
+BENCHMARK_F(TransformCompose, Quaternion, TransformFixture, 10, 0)
+{
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        sp::Quat res = rotations[pooled(i)] * rotations[pooled(i + 1)];
+        celero::DoNotOptimizeAway(res);
+    }
+}
+
+
+// full affine inverse, the class of the transformations is unknown
+BASELINE_F(TransformInverse, Affine, TransformFixture, 10, 0)
+{
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        sp::Transform3D inv = matrices[pooled(i)].inversed();
+        celero::DoNotOptimizeAway(inv);
+    }
+}
+
+BENCHMARK_F(TransformInverse, Isometry, TransformFixture, 10, 0)
+{
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        sp::Transform3D inv = isometries[pooled(i)].inversed();
+        celero::DoNotOptimizeAway(inv);
+    }
+}
+
+BENCHMARK_F(TransformInverse, UniformScale, TransformFixture, 10, 0)
+{
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        sp::Transform3D inv = uniforms[pooled(i)].inversed();
+        celero::DoNotOptimizeAway(inv);
+    }
+}
+
+BENCHMARK_F(TransformInverse, Compact, TransformFixture, 10, 0)
+{
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        sp::CompactTransform3D inv = compacts[pooled(i)].inversed();
+        celero::DoNotOptimizeAway(inv);
+    }
+}
+
+BENCHMARK_F(TransformInverse, TRS, TransformFixture, 10, 0)
+{
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        sp::TRSTransform inv = trs[pooled(i)].inversed();
+        celero::DoNotOptimizeAway(inv);
+    }
+}
+
+
+BASELINE_F(TransformApply, Scalar, TransformFixture, 10, 0)
+{
+    const sp::Transform3D & tr = transforms[0];
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        transformed[i] = tr * points[i];
+    }
+
+    celero::DoNotOptimizeAway(transformed.back());
+}
+
+BENCHMARK_F(TransformApply, Span, TransformFixture, 10, 0)
+{
+    transforms[0].applyTo(points, transformed);
+    celero::DoNotOptimizeAway(transformed.back());
+}
+
+BENCHMARK_F(TransformApply, SpanParallel, TransformFixture, 10, 0)
+{
+    transforms[0].applyTo(points, transformed, sp::Execution::Parallel);
+    celero::DoNotOptimizeAway(transformed.back());
+}
+
+BENCHMARK_F(TransformApply, Stream, TransformFixture, 10, 0)
+{
+    sp::Vec3Stream res = transforms[0].applyTo(stream);
+    celero::DoNotOptimizeAway(res);
+}
+
+BENCHMARK_F(TransformApply, TRS, TransformFixture, 10, 0)
+{
+    trs[0].applyTo(points, transformed);
+    celero::DoNotOptimizeAway(transformed.back());
+}
+
+BENCHMARK_F(TransformApply, Quaternion, TransformFixture, 10, 0)
+{
+    rotations[0].applyTo(points, transformed);
+    celero::DoNotOptimizeAway(transformed.back());
+}
@@ -25,6 +25,14 @@
 
 #include "Math/Random/Random.hpp"
 #include "Math/Batch/Batch.hpp"
+#include "Math/Parallel/Parallel.hpp"
+#include "Math/Dispatch/Dispatch.hpp"
 #include "Math/Matrix/Matrix.hpp"
+#include "Math/Matrix/Decomposition.hpp"
+#include "Math/Random/Sequence.hpp"
+#include "Math/Quaternion/Quaternion.hpp"
 #include "Math/Transform/Transform.hpp"
+#include "Math/Transform/TRS.hpp"
+#include "Math/Transform/Hierarchy.hpp"
+#include "Math/Stream/Stream.hpp"
 
@@ -26,8 +26,11 @@
 #ifndef SPIRIT_BATCH_HPP
 #define SPIRIT_BATCH_HPP
 
+#include "SPIRIT/Base.hpp"
 #include "xsimd/xsimd.hpp"
 
+#include <type_traits>
+
 namespace sp
 {
 
@@ -35,14 +38,14 @@ namespace details
 {
 
 // https://xsimd.readthedocs.io/en/latest/api/xsimd_batch.html
-// TODO: Wrap into a class that defines all operations available, 
-//  possibly emulating some behaviors.
+// Internal code uses xsimd's batch directly through this alias,
+// sp::Batch below is the stable interface for users.
 
 // At first, deifing a vectoriazable type of any size n seemed like a good idea, 
 //  but it adds complexity and favors inproper usage of simd.
 // instead the recommended approach for writing simd will be:
 //  use the batch type available at compile time and use buffers of size 
-//  sp::Batch<T>::arch_type::size aligned at alignas(sp::Batch<T>::arch_type::alignement())
+//  sp::Batch<T>::size aligned at alignas(sp::Batch<T>::alignment)
 
 // Furthermore we will not write our own matrix class. Instead we will wrap
 //  Eigen's matrix into a class whose implementation can be swapped later.
@@ -60,6 +63,523 @@ using SizedBatch = Batch<T, typename xsimd::make_sized_batch_t<T, n>::arch_type>
 } // namespace details
 
 
+template <class T, class Arch = xsimd::default_arch>
+class Batch;
+
+
+////////////////////////////////////////////////////////////
+/// \brief Result of comparisons between Batches, one bool per lane
+////////////////////////////////////////////////////////////
+template <class T, class Arch = xsimd::default_arch>
+class BatchMask
+{
+    typedef xsimd::batch_bool<T, Arch> Native;
+
+public:
+
+    constexpr static std::size_t size = Native::size;
+
+    BatchMask() = default;
+
+    // every lane set to value
+    BatchMask(bool value) : mask{value} {}
+
+    explicit BatchMask(const Native & mask) : mask{mask} {}
+
+    // lane i is bits >> i & 1
+    static BatchMask
+    fromBits(sp::Uint64 bits)
+    {
+        return BatchMask{Native::from_mask(bits)};
+    }
+
+    sp::Uint64
+    bits() const
+    {
+        return mask.mask();
+    }
+
+    bool
+    operator[](std::size_t lane) const
+    {
+        return (bits() >> lane) & 1;
+    }
+
+    bool
+    any() const
+    {
+        return xsimd::any(mask);
+    }
+
+    bool
+    all() const
+    {
+        return xsimd::all(mask);
+    }
+
+    bool
+    none() const
+    {
+        return xsimd::none(mask);
+    }
+
+    friend BatchMask
+    operator&(const BatchMask & a, const BatchMask & b)
+    {
+        return BatchMask{a.mask & b.mask};
+    }
+
+    friend BatchMask
+    operator|(const BatchMask & a, const BatchMask & b)
+    {
+        return BatchMask{a.mask | b.mask};
+    }
+
+    friend BatchMask
+    operator^(const BatchMask & a, const BatchMask & b)
+    {
+        return BatchMask{a.mask ^ b.mask};
+    }
+
+    friend BatchMask
+    operator!(const BatchMask & a)
+    {
+        return BatchMask{~a.mask};
+    }
+
+    const Native &
+    native() const
+    {
+        return mask;
+    }
+
+private:
+
+    Native mask;
+};
+
+
+////////////////////////////////////////////////////////////
+/// \brief SIMD register of sp::Batch<T>::size values of type T
+///
+/// Wraps xsimd's batch for the widest instruction set enabled at compile
+/// time (Arch), so SIMD code does not depend on xsimd directly.
+/// Operations missing from an instruction set are emulated by xsimd,
+/// rsqrt is computed as 1 / sqrt.
+///
+/// Operators and functions are applied lane by lane, except the
+/// reductions (sum, minCoeff, maxCoeff) which combine all lanes.
+///
+/// <code>
+/// typedef sp::Batch<float> Floats;
+/// for (std::size_t i = 0; i + Floats::size <= n; i += Floats::size)
+/// {
+///     Floats x = Floats::loadUnaligned(xs + i);
+///     sp::select(x > 0, sp::sqrt(x), Floats{0}).storeUnaligned(ys + i);
+/// }
+/// </code>
+////////////////////////////////////////////////////////////
+template <class T, class Arch>
+class Batch
+{
+    typedef xsimd::batch<T, Arch> Native;
+
+    constexpr static bool isIntegral = std::is_integral_v<T>;
+
+public:
+
+    typedef T value_type;
+    typedef Arch arch_type;
+    typedef BatchMask<T, Arch> Mask;
+
+    // integer type of the same size as T, for gather/scatter indices
+    typedef Batch<xsimd::as_integer_t<T>, Arch> Indices;
+
+    constexpr static std::size_t size      = Native::size;
+    constexpr static std::size_t alignment = Arch::alignment();
+
+    ////////////////////////////////////////////////////////////
+    // Construction
+    ////////////////////////////////////////////////////////////
+
+    // leaves the lanes uninitialized
+    Batch() = default;
+
+    // every lane set to value
+    Batch(T value) : batch{value} {}
+
+    explicit Batch(const Native & batch) : batch{batch} {}
+
+    // ptr must be aligned to alignment
+    static Batch
+    loadAligned(const T * ptr)
+    {
+        return Batch{Native::load_aligned(ptr)};
+    }
+
+    static Batch
+    loadUnaligned(const T * ptr)
+    {
+        return Batch{Native::load_unaligned(ptr)};
+    }
+
+    // lane i is base[indices[i]]
+    static Batch
+    gather(const T * base, const Indices & indices)
+    {
+        return Batch{Native::gather(base, indices.native())};
+    }
+
+    void
+    storeAligned(T * ptr) const
+    {
+        batch.store_aligned(ptr);
+    }
+
+    void
+    storeUnaligned(T * ptr) const
+    {
+        batch.store_unaligned(ptr);
+    }
+
+    // base[indices[i]] is set to lane i
+    void
+    scatter(T * base, const Indices & indices) const
+    {
+        batch.scatter(base, indices.native());
+    }
+
+    T
+    operator[](std::size_t lane) const
+    {
+        alignas(alignment) T values[size];
+        storeAligned(values);
+        return values[lane];
+    }
+
+    // converts every lane to U (same lane count)
+    template <class U>
+    Batch<U, Arch>
+    cast() const
+    {
+        return Batch<U, Arch>{xsimd::batch_cast<U>(batch)};
+    }
+
+    // reinterprets the bits as lanes of U (same lane count)
+    template <class U>
+    Batch<U, Arch>
+    bitCast() const
+    {
+        return Batch<U, Arch>{xsimd::bitwise_cast<U>(batch)};
+    }
+
+    const Native &
+    native() const
+    {
+        return batch;
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Reductions
+    ////////////////////////////////////////////////////////////
+
+    T
+    sum() const
+    {
+        return xsimd::reduce_add(batch);
+    }
+
+    T
+    minCoeff() const
+    {
+        return xsimd::reduce_min(batch);
+    }
+
+    T
+    maxCoeff() const
+    {
+        return xsimd::reduce_max(batch);
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Arithmetic
+    ////////////////////////////////////////////////////////////
+
+    friend Batch
+    operator+(const Batch & a, const Batch & b)
+    {
+        return Batch{a.batch + b.batch};
+    }
+
+    friend Batch
+    operator-(const Batch & a, const Batch & b)
+    {
+        return Batch{a.batch - b.batch};
+    }
+
+    friend Batch
+    operator*(const Batch & a, const Batch & b)
+    {
+        return Batch{a.batch * b.batch};
+    }
+
+    friend Batch
+    operator/(const Batch & a, const Batch & b)
+    {
+        return Batch{a.batch / b.batch};
+    }
+
+    friend Batch
+    operator-(const Batch & a)
+    {
+        return Batch{-a.batch};
+    }
+
+    Batch &
+    operator+=(const Batch & other)
+    {
+        batch += other.batch;
+        return *this;
+    }
+
+    Batch &
+    operator-=(const Batch & other)
+    {
+        batch -= other.batch;
+        return *this;
+    }
+
+    Batch &
+    operator*=(const Batch & other)
+    {
+        batch *= other.batch;
+        return *this;
+    }
+
+    Batch &
+    operator/=(const Batch & other)
+    {
+        batch /= other.batch;
+        return *this;
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Bitwise (integers only)
+    ////////////////////////////////////////////////////////////
+
+    friend Batch
+    operator&(const Batch & a, const Batch & b)
+        requires isIntegral
+    {
+        return Batch{a.batch & b.batch};
+    }
+
+    friend Batch
+    operator|(const Batch & a, const Batch & b)
+        requires isIntegral
+    {
+        return Batch{a.batch | b.batch};
+    }
+
+    friend Batch
+    operator^(const Batch & a, const Batch & b)
+        requires isIntegral
+    {
+        return Batch{a.batch ^ b.batch};
+    }
+
+    friend Batch
+    operator~(const Batch & a)
+        requires isIntegral
+    {
+        return Batch{~a.batch};
+    }
+
+    friend Batch
+    operator<<(const Batch & a, sp::Int32 shift)
+        requires isIntegral
+    {
+        return Batch{a.batch << shift};
+    }
+
+    // arithmetic shift for signed types
+    friend Batch
+    operator>>(const Batch & a, sp::Int32 shift)
+        requires isIntegral
+    {
+        return Batch{a.batch >> shift};
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Comparison
+    ////////////////////////////////////////////////////////////
+
+    friend Mask
+    operator==(const Batch & a, const Batch & b)
+    {
+        return Mask{a.batch == b.batch};
+    }
+
+    friend Mask
+    operator!=(const Batch & a, const Batch & b)
+    {
+        return Mask{a.batch != b.batch};
+    }
+
+    friend Mask
+    operator<(const Batch & a, const Batch & b)
+    {
+        return Mask{a.batch < b.batch};
+    }
+
+    friend Mask
+    operator<=(const Batch & a, const Batch & b)
+    {
+        return Mask{a.batch <= b.batch};
+    }
+
+    friend Mask
+    operator>(const Batch & a, const Batch & b)
+    {
+        return Mask{a.batch > b.batch};
+    }
+
+    friend Mask
+    operator>=(const Batch & a, const Batch & b)
+    {
+        return Mask{a.batch >= b.batch};
+    }
+
+private:
+
+    Native batch;
+};
+
+
+////////////////////////////////////////////////////////////
+// Functions
+////////////////////////////////////////////////////////////
+
+// lane i is mask[i] ? a[i] : b[i]
+template <class T, class Arch>
+Batch<T, Arch>
+select(
+    const BatchMask<T, Arch> & mask,
+    const Batch<T, Arch> & a,
+    const Batch<T, Arch> & b
+)
+{
+    return Batch<T, Arch>{xsimd::select(mask.native(), a.native(), b.native())};
+}
+
+template <class T, class Arch>
+Batch<T, Arch>
+min(const Batch<T, Arch> & a, const Batch<T, Arch> & b)
+{
+    return Batch<T, Arch>{xsimd::min(a.native(), b.native())};
+}
+
+template <class T, class Arch>
+Batch<T, Arch>
+max(const Batch<T, Arch> & a, const Batch<T, Arch> & b)
+{
+    return Batch<T, Arch>{xsimd::max(a.native(), b.native())};
+}
+
+template <class T, class Arch>
+Batch<T, Arch>
+abs(const Batch<T, Arch> & a)
+{
+    return Batch<T, Arch>{xsimd::abs(a.native())};
+}
+
+// a * b + c, fused when the instruction set allows it
+template <class T, class Arch>
+Batch<T, Arch>
+fma(const Batch<T, Arch> & a, const Batch<T, Arch> & b, const Batch<T, Arch> & c)
+{
+    return Batch<T, Arch>{xsimd::fma(a.native(), b.native(), c.native())};
+}
+
+template <class T, class Arch>
+    requires std::is_floating_point_v<T>
+Batch<T, Arch>
+floor(const Batch<T, Arch> & a)
+{
+    return Batch<T, Arch>{xsimd::floor(a.native())};
+}
+
+template <class T, class Arch>
+    requires std::is_floating_point_v<T>
+Batch<T, Arch>
+ceil(const Batch<T, Arch> & a)
+{
+    return Batch<T, Arch>{xsimd::ceil(a.native())};
+}
+
+// halfway cases away from zero, like std::round
+template <class T, class Arch>
+    requires std::is_floating_point_v<T>
+Batch<T, Arch>
+round(const Batch<T, Arch> & a)
+{
+    return Batch<T, Arch>{xsimd::round(a.native())};
+}
+
+template <class T, class Arch>
+    requires std::is_floating_point_v<T>
+Batch<T, Arch>
+sqrt(const Batch<T, Arch> & a)
+{
+    return Batch<T, Arch>{xsimd::sqrt(a.native())};
+}
+
+// 1 / sqrt(a), at full precision
+template <class T, class Arch>
+    requires std::is_floating_point_v<T>
+Batch<T, Arch>
+rsqrt(const Batch<T, Arch> & a)
+{
+    return Batch<T, Arch>{xsimd::batch<T, Arch>{1} / xsimd::sqrt(a.native())};
+}
+
+template <class T, class Arch>
+    requires std::is_floating_point_v<T>
+Batch<T, Arch>
+sin(const Batch<T, Arch> & a)
+{
+    return Batch<T, Arch>{xsimd::sin(a.native())};
+}
+
+template <class T, class Arch>
+    requires std::is_floating_point_v<T>
+Batch<T, Arch>
+cos(const Batch<T, Arch> & a)
+{
+    return Batch<T, Arch>{xsimd::cos(a.native())};
+}
+
+template <class T, class Arch>
+    requires std::is_floating_point_v<T>
+Batch<T, Arch>
+exp(const Batch<T, Arch> & a)
+{
+    return Batch<T, Arch>{xsimd::exp(a.native())};
+}
+
+template <class T, class Arch>
+    requires std::is_floating_point_v<T>
+Batch<T, Arch>
+log(const Batch<T, Arch> & a)
+{
+    return Batch<T, Arch>{xsimd::log(a.native())};
+}
+
+
+typedef sp::Batch<float> BatchF;
+typedef sp::Batch<double> BatchD;
+typedef sp::Batch<sp::Int32> BatchI;
+
 } // namespace sp
 
 
@@ -0,0 +1,348 @@
+////////////////////////////////////////////////////////////
+//
+// Spirit
+// Copyright (C) 2022 Matthieu Beauchamp-Boulay
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it freely,
+// subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+////////////////////////////////////////////////////////////
+
+
+#ifndef SPIRIT_DISPATCH_HPP
+#define SPIRIT_DISPATCH_HPP
+
+#include "SPIRIT/Base.hpp"
+#include "SPIRIT/Math/Random/Bulk.hpp"
+#include "SPIRIT/Math/Random/Philox.hpp"
+#include "SPIRIT/Math/Random/Ziggurat.hpp"
+#include "SPIRIT/Math/Transform/Bulk.hpp"
+
+#include <type_traits>
+
+
+////////////////////////////////////////////////////////////
+// Runtime selection of the instruction set of the hot kernels.
+//
+// Headers are compiled for xsimd::default_arch, the instruction set enabled
+// by the compiler flags. When spirit-math is built with
+// SPIRIT_MATH_RUNTIME_DISPATCH (x86 only), the kernels listed in
+// details::Kernels are also compiled for SSE2, AVX2 (with FMA) and AVX-512
+// in their own translation units (src/SPIRIT/Dispatch) and the best one
+// supported by the CPU is chosen on first use.
+//
+// Those are the bulk random fills of the Philox engine and the bulk
+// applications of float and double, 2D and 3D sp::Transformation.
+// The other bulk operations stay on xsimd::default_arch: MatStream ones
+// are templates over every shape, with a layout fixed by their Arch
+// parameter, and the Quaternion and TRSTransformation ones are not
+// dispatched yet.
+//
+// Those units must not provide any function the baseline code could use:
+// the linker keeps a single copy of an inline function, possibly one built
+// for AVX-512. Only the templates taking Arch are instantiated there, the
+// scalar paths they call are compiled once, in src/SPIRIT/Instantiation,
+// which test/checkDispatch.py verifies on the built library (Dispatch-test).
+// This relies on the kernels being inlined and can only be checked on
+// static libraries built with GCC or Clang: the option is off by default
+// with MSVC and shared libraries.
+//
+// The choice can be forced with the SPIRIT_MATH_ARCH environment variable
+// set to sse2, avx2 or avx512. An instruction set the CPU does not support
+// is ignored.
+////////////////////////////////////////////////////////////
+
+namespace sp
+{
+
+enum class SimdArch
+{
+    Native, // xsimd::default_arch, no runtime dispatch
+    Sse2,
+    Avx2,
+    Avx512
+};
+
+// Instruction set used by the dispatched kernels
+SimdArch
+getSimdArch();
+
+const char *
+getSimdArchName(SimdArch arch);
+
+
+namespace details
+{
+
+// see Transform/Bulk.hpp
+template <class T, sp::Int32 dim>
+struct TransformKernels
+{
+    void (*packed)(const T *, const T *, T *, std::size_t, bool);
+    void (*split)(const T *, const T * const *, T * const *, std::size_t, bool);
+};
+
+// Entry points of the dispatched kernels, with engine = sp::Philox.
+// The Ziggurat tables are built by the caller, with the baseline instruction set.
+struct Kernels
+{
+    void (*uniformFloat)(sp::Philox &, float *, std::size_t, float, float);
+    void (*uniformDouble)(sp::Philox &, double *, std::size_t, double, double);
+    void (*uniformInt)(sp::Philox &, sp::Int32 *, std::size_t, sp::Int32, sp::Int32);
+    void (*uniformUint)(sp::Philox &, sp::Uint32 *, std::size_t, sp::Uint32, sp::Uint32);
+
+    void (*gaussFloat)(
+        const Ziggurat<float> &, sp::Philox &, float *, std::size_t, float, float
+    );
+    void (*gaussDouble)(
+        const Ziggurat<double> &, sp::Philox &, double *, std::size_t, double, double
+    );
+    void (*gaussRounded)(
+        const Ziggurat<float> &, sp::Philox &, sp::Int32 *, std::size_t, float, float
+    );
+
+    TransformKernels<float, 2> transformFloat2;
+    TransformKernels<float, 3> transformFloat3;
+    TransformKernels<double, 2> transformDouble2;
+    TransformKernels<double, 3> transformDouble3;
+};
+
+template <class Arch, class T, sp::Int32 dim>
+constexpr TransformKernels<T, dim>
+makeTransformKernels()
+{
+    return {&transformPacked<Arch, T, dim>, &transformSplit<Arch, T, dim>};
+}
+
+template <class Arch>
+Kernels
+makeKernels()
+{
+    return {
+        &uniformFill<Arch, sp::Philox>,
+        &uniformFill<Arch, sp::Philox>,
+        &uniformIntFill<Arch, sp::Int32, sp::Philox>,
+        &uniformIntFill<Arch, sp::Uint32, sp::Philox>,
+        [](const Ziggurat<float> & ziggurat,
+           sp::Philox & engine,
+           float * out,
+           std::size_t n,
+           float mean,
+           float stdDev) { ziggurat.fill<Arch>(engine, out, n, mean, stdDev); },
+        [](const Ziggurat<double> & ziggurat,
+           sp::Philox & engine,
+           double * out,
+           std::size_t n,
+           double mean,
+           double stdDev) { ziggurat.fill<Arch>(engine, out, n, mean, stdDev); },
+        [](const Ziggurat<float> & ziggurat,
+           sp::Philox & engine,
+           sp::Int32 * out,
+           std::size_t n,
+           float mean,
+           float stdDev) { ziggurat.fillRounded<Arch>(engine, out, n, mean, stdDev); },
+        makeTransformKernels<Arch, float, 2>(),
+        makeTransformKernels<Arch, float, 3>(),
+        makeTransformKernels<Arch, double, 2>(),
+        makeTransformKernels<Arch, double, 3>()};
+}
+
+// Kernels for getSimdArch(), defined in src/SPIRIT/Dispatch
+const Kernels &
+dispatchedKernels();
+
+// makeKernels<Arch>(), each defined in the unit compiled for Arch.
+// Arch is part of their names, see test/checkDispatch.py.
+template <class Arch>
+const Kernels &
+archKernels();
+
+#ifdef SPIRIT_MATH_RUNTIME_DISPATCH
+template <>
+const Kernels &
+archKernels<xsimd::sse2>();
+
+template <>
+const Kernels &
+archKernels<xsimd::fma3<xsimd::avx2>>();
+
+template <>
+const Kernels &
+archKernels<xsimd::avx512f>();
+#endif
+
+
+////////////////////////////////////////////////////////////
+// Calls the dispatched kernel when available,
+// otherwise the one compiled for xsimd::default_arch.
+////////////////////////////////////////////////////////////
+
+template <class Engine, class T>
+void
+dispatchUniform(Engine & engine, T * out, std::size_t n, T a, T b)
+{
+#ifdef SPIRIT_MATH_RUNTIME_DISPATCH
+    if constexpr (std::is_same_v<Engine, sp::Philox>)
+    {
+        const Kernels & kernels = dispatchedKernels();
+        if constexpr (std::is_same_v<T, float>)
+        {
+            return kernels.uniformFloat(engine, out, n, a, b);
+        }
+        else if constexpr (std::is_same_v<T, double>)
+        {
+            return kernels.uniformDouble(engine, out, n, a, b);
+        }
+        else if constexpr (std::is_same_v<T, sp::Int32>)
+        {
+            return kernels.uniformInt(engine, out, n, a, b);
+        }
+        else
+        {
+            return kernels.uniformUint(engine, out, n, a, b);
+        }
+    }
+#endif
+
+    if constexpr (std::is_floating_point_v<T>)
+    {
+        uniformFill(engine, out, n, a, b);
+    }
+    else
+    {
+        uniformIntFill(engine, out, n, a, b);
+    }
+}
+
+template <class Engine, class T>
+void
+dispatchGauss(Engine & engine, T * out, std::size_t n, T mean, T stdDev)
+{
+#ifdef SPIRIT_MATH_RUNTIME_DISPATCH
+    if constexpr (std::is_same_v<Engine, sp::Philox>)
+    {
+        const Ziggurat<T> & ziggurat = Ziggurat<T>::instance();
+        if constexpr (std::is_same_v<T, float>)
+        {
+            return dispatchedKernels().gaussFloat(ziggurat, engine, out, n, mean, stdDev);
+        }
+        else
+        {
+            return dispatchedKernels().gaussDouble(ziggurat, engine, out, n, mean, stdDev);
+        }
+    }
+#endif
+
+    Ziggurat<T>::instance().fill(engine, out, n, mean, stdDev);
+}
+
+template <class Engine>
+void
+dispatchGaussRounded(
+    Engine & engine,
+    sp::Int32 * out,
+    std::size_t n,
+    float mean,
+    float stdDev
+)
+{
+#ifdef SPIRIT_MATH_RUNTIME_DISPATCH
+    if constexpr (std::is_same_v<Engine, sp::Philox>)
+    {
+        return dispatchedKernels().gaussRounded(
+            Ziggurat<float>::instance(),
+            engine,
+            out,
+            n,
+            mean,
+            stdDev
+        );
+    }
+#endif
+
+    Ziggurat<float>::instance().fillRounded(engine, out, n, mean, stdDev);
+}
+
+#ifdef SPIRIT_MATH_RUNTIME_DISPATCH
+template <class T, sp::Int32 dim>
+const TransformKernels<T, dim> *
+dispatchedTransformKernels()
+{
+    const Kernels & kernels = dispatchedKernels();
+    if constexpr (std::is_same_v<T, float> && dim == 2)
+    {
+        return &kernels.transformFloat2;
+    }
+    else if constexpr (std::is_same_v<T, float> && dim == 3)
+    {
+        return &kernels.transformFloat3;
+    }
+    else if constexpr (std::is_same_v<T, double> && dim == 2)
+    {
+        return &kernels.transformDouble2;
+    }
+    else if constexpr (std::is_same_v<T, double> && dim == 3)
+    {
+        return &kernels.transformDouble3;
+    }
+    else
+    {
+        return nullptr;
+    }
+}
+#endif
+
+template <class T, sp::Int32 dim>
+void
+dispatchTransformPacked(const T * affine, const T * src, T * dst, std::size_t n, bool isPoint)
+{
+#ifdef SPIRIT_MATH_RUNTIME_DISPATCH
+    if (const TransformKernels<T, dim> * kernels = dispatchedTransformKernels<T, dim>())
+    {
+        return kernels->packed(affine, src, dst, n, isPoint);
+    }
+#endif
+
+    transformPacked<xsimd::default_arch, T, dim>(affine, src, dst, n, isPoint);
+}
+
+template <class T, sp::Int32 dim>
+void
+dispatchTransformSplit(
+    const T * affine,
+    const T * const * src,
+    T * const * dst,
+    std::size_t n,
+    bool isPoint
+)
+{
+#ifdef SPIRIT_MATH_RUNTIME_DISPATCH
+    if (const TransformKernels<T, dim> * kernels = dispatchedTransformKernels<T, dim>())
+    {
+        return kernels->split(affine, src, dst, n, isPoint);
+    }
+#endif
+
+    transformSplit<xsimd::default_arch, T, dim>(affine, src, dst, n, isPoint);
+}
+
+} // namespace details
+
+} // namespace sp
+
+
+#endif // SPIRIT_DISPATCH_HPP
@@ -0,0 +1,156 @@
+////////////////////////////////////////////////////////////
+//
+// Spirit
+// Copyright (C) 2022 Matthieu Beauchamp-Boulay
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it freely,
+// subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+////////////////////////////////////////////////////////////
+
+
+#ifndef SPIRIT_DECOMPOSITION_HPP
+#define SPIRIT_DECOMPOSITION_HPP
+
+#include "SPIRIT/Base.hpp"
+#include "SPIRIT/Math/Matrix/Matrix.hpp"
+
+#include "Eigen/Cholesky"
+#include "Eigen/LU"
+#include "Eigen/QR"
+
+
+namespace sp
+{
+
+namespace details
+{
+
+////////////////////////////////////////////////////////////
+/// \brief Factorization of a matrix, kept to solve many systems
+///
+/// Matrix::solve factors the matrix on every call, a Decomposition
+/// factors it once with compute() and then solves for as many right
+/// hand sides as needed.
+///
+/// compute() can be called again when the matrix changes,
+/// the storage of the previous factorization is reused if the size
+/// did not change.
+///
+/// <code>
+/// sp::LDLT<float, 6> ldlt{massMatrix};
+/// for (const sp::Vector<float, 6> & impulse : impulses)
+///     velocities.push_back(ldlt.solve(impulse));
+/// </code>
+////////////////////////////////////////////////////////////
+template <class Solver>
+class Decomposition
+{
+    typedef typename Solver::MatrixType Mat;
+    typedef typename Mat::Scalar T;
+
+    constexpr static sp::Int32 mRows = Mat::RowsAtCompileTime;
+    constexpr static sp::Int32 nCols = Mat::ColsAtCompileTime;
+
+public:
+
+    typedef sp::Matrix<T, mRows, nCols> Factored;
+
+    // compute() must be called before solving
+    Decomposition() = default;
+
+    explicit Decomposition(const Factored & matrix) { compute(matrix); }
+
+    // Factors matrix, replacing the previous factorization
+    Decomposition &
+    compute(const Factored & matrix)
+    {
+        solver.compute(matrix.mat);
+        isComputed = true;
+        return *this;
+    }
+
+    // false if the factorization failed (e.g. Cholesky of a matrix that is
+    // not positive definite), solutions are junk in that case.
+    bool
+    isValid() const
+    {
+        if constexpr (requires { solver.info(); })
+        {
+            return isComputed && solver.info() == Eigen::Success;
+        }
+        else
+        {
+            return isComputed;
+        }
+    }
+
+    // Solves Ax=b for x, where A is the factored matrix
+    template <sp::Int32 nColsOther>
+    Matrix<T, nCols, nColsOther>
+    solve(const Matrix<T, mRows, nColsOther> & b) const
+    {
+        SPIRIT_ASSERT(isComputed)
+        return Matrix<T, nCols, nColsOther>{solver.solve(b.mat)};
+    }
+
+    // Same as above, writes in x to reuse its storage
+    template <sp::Int32 nColsOther>
+    void
+    solve(const Matrix<T, mRows, nColsOther> & b, Matrix<T, nCols, nColsOther> & x)
+        const
+    {
+        SPIRIT_ASSERT(isComputed)
+        x.mat = solver.solve(b.mat);
+    }
+
+private:
+
+    Solver solver;
+    bool isComputed = false;
+};
+
+} // namespace details
+
+
+// Householder QR, fast but requires a full rank matrix
+template <class T, sp::Int32 mRows, sp::Int32 nCols>
+using QR = details::Decomposition<
+    Eigen::HouseholderQR<details::MatrixBase<T, mRows, nCols>>>;
+
+// Column pivoting Householder QR, slower but accurate for any matrix
+template <class T, sp::Int32 mRows, sp::Int32 nCols>
+using AccurateQR = details::Decomposition<
+    Eigen::ColPivHouseholderQR<details::MatrixBase<T, mRows, nCols>>>;
+
+// Partial pivoting LU, for invertible matrices
+template <class T, sp::Int32 dim>
+using LU = details::Decomposition<
+    Eigen::PartialPivLU<details::MatrixBase<T, dim, dim>>>;
+
+// Robust Cholesky, for positive or negative semidefinite matrices
+template <class T, sp::Int32 dim>
+using LDLT = details::Decomposition<Eigen::LDLT<details::MatrixBase<T, dim, dim>>>;
+
+// Cholesky, fastest, for positive definite matrices
+template <class T, sp::Int32 dim>
+using Cholesky = details::Decomposition<Eigen::LLT<details::MatrixBase<T, dim, dim>>>;
+
+} // namespace sp
+
+
+#endif // SPIRIT_DECOMPOSITION_HPP
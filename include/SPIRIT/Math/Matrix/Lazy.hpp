@@ -0,0 +1,336 @@
+////////////////////////////////////////////////////////////
+//
+// Spirit
+// Copyright (C) 2022 Matthieu Beauchamp-Boulay
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it freely,
+// subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+////////////////////////////////////////////////////////////
+
+
+#ifndef SPIRIT_LAZY_HPP
+#define SPIRIT_LAZY_HPP
+
+#include "SPIRIT/Base.hpp"
+#include "SPIRIT/Math/Matrix/Matrix.hpp"
+
+#include <algorithm>
+#include <array>
+#include <type_traits>
+
+
+namespace sp
+{
+
+////////////////////////////////////////////////////////////
+/// \brief Unevaluated expression of Matrices
+///
+/// Matrix operators evaluate every intermediate result to stay safe from
+/// aliasing. Expressions started with sp::lazy keep Eigen's expression
+/// instead, so a chain such as
+///
+/// <code>
+/// res = sp::lazy(A) * a + sp::lazy(B) * b + sp::lazy(C) * c;
+/// </code>
+///
+/// is evaluated in a single pass, without temporaries.
+///
+/// The expression remembers which matrices it reads (its leaves).
+/// When it is assigned to one of them, it is evaluated in a temporary
+/// first, otherwise it is written directly to the destination (noalias).
+///
+/// \warning The leaves are referenced, not copied: the expression must be
+///          assigned before any of them goes out of scope.
+////////////////////////////////////////////////////////////
+template <class Expr, std::size_t nLeaves>
+class LazyExpr
+{
+public:
+
+    typedef std::remove_cvref_t<Expr> Expression;
+    typedef typename Expression::Scalar Scalar;
+    typedef std::array<const void *, nLeaves> Leaves;
+
+    constexpr static sp::Int32 rows = Expression::RowsAtCompileTime;
+    constexpr static sp::Int32 cols = Expression::ColsAtCompileTime;
+
+    LazyExpr(Expr expr, const Leaves & leaves) : expr{expr}, leaves{leaves} {}
+
+    [[nodiscard]] Matrix<Scalar, rows, cols>
+    eval() const
+    {
+        return *this;
+    }
+
+    [[nodiscard]] auto
+    transposed() const
+    {
+        return LazyExpr<decltype(expr.transpose()), nLeaves>{expr.transpose(), leaves};
+    }
+
+    // true if the expression reads from the coefficients at data
+    bool
+    aliases(const void * data) const
+    {
+        return std::find(leaves.begin(), leaves.end(), data) != leaves.end();
+    }
+
+    const Expression &
+    expression() const
+    {
+        return expr;
+    }
+
+    const Leaves &
+    getLeaves() const
+    {
+        return leaves;
+    }
+
+private:
+
+    Expr expr;
+    Leaves leaves;
+};
+
+
+////////////////////////////////////////////////////////////
+/// \brief Starts a lazy expression from mat
+///
+/// See sp::LazyExpr.
+////////////////////////////////////////////////////////////
+template <class T, sp::Int32 mRows, sp::Int32 nCols>
+LazyExpr<const sp::details::MatrixBase<T, mRows, nCols> &, 1>
+lazy(const Matrix<T, mRows, nCols> & mat)
+{
+    return {mat.mat, {mat.mat.data()}};
+}
+
+// would reference a destroyed matrix
+template <class T, sp::Int32 mRows, sp::Int32 nCols>
+void
+lazy(const Matrix<T, mRows, nCols> && mat)
+    = delete;
+
+
+namespace details
+{
+
+template <class T>
+constexpr bool isLazy = false;
+
+template <class Expr, std::size_t nLeaves>
+constexpr bool isLazy<LazyExpr<Expr, nLeaves>> = true;
+
+template <class T>
+constexpr bool isMatrix = false;
+
+template <class T, sp::Int32 mRows, sp::Int32 nCols>
+constexpr bool isMatrix<Matrix<T, mRows, nCols>> = true;
+
+// Operands of lazy operators, at least one of them must already be lazy
+template <class L, class R>
+concept LazyOperands = (isLazy<L> || isLazy<R>)
+                       && (isLazy<L> || isMatrix<L>)
+                       && (isLazy<R> || isMatrix<R>);
+
+template <class T>
+const T &
+toLazy(const T & operand)
+{
+    return operand;
+}
+
+template <class T, sp::Int32 mRows, sp::Int32 nCols>
+auto
+toLazy(const Matrix<T, mRows, nCols> & operand)
+{
+    return sp::lazy(operand);
+}
+
+template <class Expr, std::size_t nLhs, std::size_t nRhs>
+LazyExpr<Expr, nLhs + nRhs>
+makeLazy(
+    const Expr & expr,
+    const std::array<const void *, nLhs> & lhsLeaves,
+    const std::array<const void *, nRhs> & rhsLeaves
+)
+{
+    std::array<const void *, nLhs + nRhs> leaves;
+    std::copy(lhsLeaves.begin(), lhsLeaves.end(), leaves.begin());
+    std::copy(rhsLeaves.begin(), rhsLeaves.end(), leaves.begin() + nLhs);
+    return {expr, leaves};
+}
+
+} // namespace details
+
+
+////////////////////////////////////////////////////////////
+// Lazy operators
+////////////////////////////////////////////////////////////
+
+template <class L, class R>
+    requires details::LazyOperands<L, R>
+auto
+operator+(const L & lhs, const R & rhs)
+{
+    auto l = details::toLazy(lhs);
+    auto r = details::toLazy(rhs);
+    return details::makeLazy(
+        l.expression() + r.expression(),
+        l.getLeaves(),
+        r.getLeaves()
+    );
+}
+
+template <class L, class R>
+    requires details::LazyOperands<L, R>
+auto
+operator-(const L & lhs, const R & rhs)
+{
+    auto l = details::toLazy(lhs);
+    auto r = details::toLazy(rhs);
+    return details::makeLazy(
+        l.expression() - r.expression(),
+        l.getLeaves(),
+        r.getLeaves()
+    );
+}
+
+// Matrix product
+template <class L, class R>
+    requires details::LazyOperands<L, R>
+auto
+operator*(const L & lhs, const R & rhs)
+{
+    auto l = details::toLazy(lhs);
+    auto r = details::toLazy(rhs);
+    return details::makeLazy(
+        l.expression() * r.expression(),
+        l.getLeaves(),
+        r.getLeaves()
+    );
+}
+
+template <class Expr, std::size_t nLeaves>
+auto
+operator-(const LazyExpr<Expr, nLeaves> & expr)
+{
+    auto res = -expr.expression();
+    return LazyExpr<decltype(res), nLeaves>{res, expr.getLeaves()};
+}
+
+template <class Expr, std::size_t nLeaves>
+auto
+operator*(
+    const LazyExpr<Expr, nLeaves> & expr,
+    typename LazyExpr<Expr, nLeaves>::Scalar scalar
+)
+{
+    auto res = expr.expression() * scalar;
+    return LazyExpr<decltype(res), nLeaves>{res, expr.getLeaves()};
+}
+
+template <class Expr, std::size_t nLeaves>
+auto
+operator*(
+    typename LazyExpr<Expr, nLeaves>::Scalar scalar,
+    const LazyExpr<Expr, nLeaves> & expr
+)
+{
+    return expr * scalar;
+}
+
+template <class Expr, std::size_t nLeaves>
+auto
+operator/(
+    const LazyExpr<Expr, nLeaves> & expr,
+    typename LazyExpr<Expr, nLeaves>::Scalar scalar
+)
+{
+    auto res = expr.expression() / scalar;
+    return LazyExpr<decltype(res), nLeaves>{res, expr.getLeaves()};
+}
+
+
+////////////////////////////////////////////////////////////
+// Matrix assignment from lazy expressions
+////////////////////////////////////////////////////////////
+
+template <class T, sp::Int32 mRows, sp::Int32 nCols>
+template <class Expr, std::size_t nLeaves>
+Matrix<T, mRows, nCols>::Matrix(const LazyExpr<Expr, nLeaves> & expr)
+    : mat{expr.expression()}
+{
+}
+
+template <class T, sp::Int32 mRows, sp::Int32 nCols>
+template <class Expr, std::size_t nLeaves>
+Matrix<T, mRows, nCols> &
+Matrix<T, mRows, nCols>::operator=(const LazyExpr<Expr, nLeaves> & expr)
+{
+    if (expr.aliases(mat.data()))
+    {
+        mat = expr.expression().eval();
+    }
+    else
+    {
+        mat.noalias() = expr.expression();
+    }
+
+    return *this;
+}
+
+template <class T, sp::Int32 mRows, sp::Int32 nCols>
+template <class Expr, std::size_t nLeaves>
+Matrix<T, mRows, nCols> &
+Matrix<T, mRows, nCols>::operator+=(const LazyExpr<Expr, nLeaves> & expr)
+{
+    if (expr.aliases(mat.data()))
+    {
+        mat += expr.expression().eval();
+    }
+    else
+    {
+        mat.noalias() += expr.expression();
+    }
+
+    return *this;
+}
+
+template <class T, sp::Int32 mRows, sp::Int32 nCols>
+template <class Expr, std::size_t nLeaves>
+Matrix<T, mRows, nCols> &
+Matrix<T, mRows, nCols>::operator-=(const LazyExpr<Expr, nLeaves> & expr)
+{
+    if (expr.aliases(mat.data()))
+    {
+        mat -= expr.expression().eval();
+    }
+    else
+    {
+        mat.noalias() -= expr.expression();
+    }
+
+    return *this;
+}
+
+} // namespace sp
+
+
+#endif // SPIRIT_LAZY_HPP
@@ -27,7 +27,7 @@
 #define SPIRIT_MATRIX_HPP
 
 #include "SPIRIT/Base.hpp"
-#include "Eigen/Core"
+#include "Eigen/Dense"
 
 namespace sp
 {
@@ -207,17 +207,41 @@ using MatrixBase = Eigen::Matrix<
 
 // };
 
+template <class Solver>
+class Decomposition;
+
 } // namespace details
 
 
-template <class, sp::Int32>
+// Size of a dimension only known at runtime
+constexpr sp::Int32 Dynamic = Eigen::Dynamic;
+
+
+// Storage of the matrix of a sp::Transformation
+enum class TransformStorage
+{
+    Affine,       // (dim + 1) x (dim + 1), last row is [0 ... 0 1]
+    AffineCompact // dim x (dim + 1), the constant last row is not stored
+};
+
+template <class, sp::Int32, TransformStorage = TransformStorage::Affine>
 class Transformation;
 
+template <class>
+class TRSTransformation;
+
+template <class>
+class Quaternion;
+
+template <class, std::size_t>
+class LazyExpr;
+
 
 // Here we remove some of Eigen's optimization potential by converting results
 // back to matrices. This is to avoid unexpected bugs due to aliasing.
 // Furthermore, we don't expect any big equations in our usage.
 //  any complex calculations can be made into a method using Eigen's Matrix
+//  or written as a lazy expression, see sp::lazy
 template <class T, sp::Int32 mRows, sp::Int32 nCols>
 class Matrix
 {
@@ -225,6 +249,13 @@ class Matrix
     constexpr static bool isRowVector = mRows == 1 && !isColVector;
     constexpr static bool isValue     = isColVector && mRows == 1;
     constexpr static bool isVector    = isRowVector || isColVector;
+    constexpr static bool isDynamic   = mRows == sp::Dynamic || nCols == sp::Dynamic;
+
+    constexpr static sp::Int32
+    grown(sp::Int32 dimension)
+    {
+        return dimension == sp::Dynamic ? sp::Dynamic : dimension + 1;
+    }
 
 public:
 
@@ -232,36 +263,63 @@ public:
     // Construction and assignement
     ////////////////////////////////////////////////////////////
 
-    // leaves the matrix uninitialized
+    // leaves the matrix uninitialized, dynamic matrices are empty
     Matrix() {}
 
+    // leaves the matrix uninitialized
+    Matrix(sp::Int32 rows, sp::Int32 cols)
+        requires isDynamic
+        : mat(rows, cols)
+    {
+    }
+
+    // dynamic vectors take the size of values
+    // use initialization per row if this is not a vector
     Matrix(std::initializer_list<T> values)
+        requires isVector
     {
-        static_assert(
-            isVector,
-            "Use initialization per row if this is not a vector"
-        );
-        for (sp::Int32 i = 0; i < nCols * mRows; ++i)
+        sp::Int32 size = static_cast<sp::Int32>(values.size());
+        if constexpr (isDynamic)
+        {
+            mat.resize(isColVector ? size : 1, isColVector ? 1 : size);
+        }
+
+        SPIRIT_ASSERT(size == this->size())
+        for (sp::Int32 i = 0; i < size; ++i)
         {
             mat[i] = values.begin()[i];
         }
     }
 
+    // use coefficient initialization if this is a vector
     Matrix(const std::initializer_list<std::initializer_list<T>> & rows)
+        requires(!isVector)
         : mat{rows}
     {
-        static_assert(
-            !isVector,
-            "use coefficient initialization if this is a vector"
-        );
     }
 
     Matrix(const Matrix &) = default;
 
+    // dynamic matrices give their buffer, other is left empty
+    Matrix(Matrix &&) = default;
+
     Matrix &
     operator=(const Matrix &)
         = default;
 
+    Matrix &
+    operator=(Matrix &&)
+        = default;
+
+    // Evaluates a lazy expression, see sp::lazy
+    template <class Expr, std::size_t nLeaves>
+    Matrix(const LazyExpr<Expr, nLeaves> & expr);
+
+    // Evaluates in a temporary first if expr reads from this matrix
+    template <class Expr, std::size_t nLeaves>
+    Matrix &
+    operator=(const LazyExpr<Expr, nLeaves> & expr);
+
 
     ////////////////////////////////////////////////////////////
     // Static construction
@@ -290,38 +348,59 @@ public:
         return Matrix{Mat::Random()};
     }
 
+    static Matrix
+    Identity(sp::Int32 rows, sp::Int32 cols)
+        requires isDynamic
+    {
+        return Matrix{Mat::Identity(rows, cols)};
+    }
+
+    static Matrix
+    Zero(sp::Int32 rows, sp::Int32 cols)
+        requires isDynamic
+    {
+        return Matrix{Mat::Zero(rows, cols)};
+    }
+
+    static Matrix
+    Random(sp::Int32 rows, sp::Int32 cols)
+        requires isDynamic
+    {
+        return Matrix{Mat::Random(rows, cols)};
+    }
+
     static Matrix
     Unit(sp::Int32 dimension)
+        requires isVector
     {
-        static_assert(isVector, "Must be a Vector type");
         return Matrix{Mat::Unit(dimension)};
     }
 
     static Matrix
     UnitX()
+        requires isVector
     {
-        static_assert(isVector, "Must be a Vector type");
         return Matrix{Mat::UnitX()};
     }
 
     static Matrix
     UnitY()
+        requires(isVector && (isDynamic || mRows * nCols >= 2))
     {
-        static_assert(isVector, "Must be a Vector type");
         return Matrix{Mat::UnitY()};
     }
 
     static Matrix
     UnitZ()
+        requires(isVector && (isDynamic || mRows * nCols >= 3))
     {
-        static_assert(isVector, "Must be a Vector type");
         return Matrix{Mat::UnitZ()};
     }
 
     static Matrix
     UnitW()
+        requires(isVector && (isDynamic || mRows * nCols >= 4))
     {
-        static_assert(isVector, "Must be a Vector type");
         return Matrix{Mat::UnitW()};
     }
 
@@ -330,12 +409,12 @@ public:
     // Conversions / transformations
     ////////////////////////////////////////////////////////////
 
-    typedef Matrix<T, isRowVector ? mRows + 1 : mRows, isColVector ? nCols + 1 : nCols>
+    typedef Matrix<T, isColVector ? grown(mRows) : mRows, isRowVector ? grown(nCols) : nCols>
         Homogeneous;
     Homogeneous
     homogeneous() const
+        requires isVector
     {
-        static_assert(isVector, "Must be a Vector type");
         return Homogeneous{mat.homogeneous()};
     }
 
@@ -348,8 +427,8 @@ public:
 
     void
     transpose()
+        requires(mRows == nCols)
     {
-        static_assert(mRows == nCols, "Must be square");
         mat.transposeInPlace();
     }
 
@@ -357,6 +436,7 @@ public:
     // otherwise false (is the matrix still preserved?)
     bool
     inverse()
+        requires(mRows == nCols)
     {
         bool wasInversed;
         mat.computeInverseWithCheck(mat, wasInversed);
@@ -365,6 +445,7 @@ public:
 
     [[nodiscard]] Matrix
     inversed(bool & wasInversed) const
+        requires(mRows == nCols)
     {
         Matrix inv;
         mat.computeInverseWithCheck(inv.mat, wasInversed);
@@ -436,30 +517,30 @@ public:
 
     T
     squaredNorm() const
+        requires isVector
     {
-        static_assert(isVector, "Must be a vector type");
         return mat.squaredNorm();
     }
     T
     norm() const
+        requires isVector
     {
-        static_assert(isVector, "Must be a vector type");
         return mat.norm();
     }
 
     // unchanged if norm == 0
     void
     normalize()
+        requires isVector
     {
-        static_assert(isVector, "Must be a vector type");
         mat.normalize();
     }
 
     // returns *this if norm == 0
     Matrix
     normalized() const
+        requires isVector
     {
-        static_assert(isVector, "Must be a vector type");
         return Matrix{mat.normalized()};
     }
 
@@ -469,6 +550,8 @@ public:
 
     // if no good solution is found, returns junk
     // if many solutions exists, chooses one arbitrarily
+    // the matrix is factored on every call, see sp::QR, sp::LU, sp::LDLT, ...
+    // to solve many systems with the same matrix
 
     template <class U, sp::Int32 nColsOther>
     Matrix<T, nCols, nColsOther>
@@ -520,6 +603,14 @@ public:
         return mat.rows();
     }
 
+    // contents are left uninitialized when the size changes
+    void
+    resize(sp::Int32 rows, sp::Int32 cols)
+        requires isDynamic
+    {
+        mat.resize(rows, cols);
+    }
+
     // TODO: col and row should return an object that provides read/write access
     //  and from which a new matrix can be constructed
     Matrix<T, mRows, 1>
@@ -538,17 +629,18 @@ public:
     // auto colwise() {return mat.colwise();}
     // auto rowwise() {return mat.rowwise();}
 
+    // vectors only, use matrix(row, column) for matrices
     T &
     operator[](sp::Int32 index)
+        requires isVector
     {
-        static_assert(isVector, "Disabled for matrices, use matrix(row, column)");
         return mat[index];
     }
 
     const T &
     operator[](sp::Int32 index) const
+        requires isVector
     {
-        static_assert(isVector, "Disabled for matrices, use matrix(row, column)");
         return mat[index];
     }
 
@@ -596,6 +688,14 @@ public:
         return *this;
     }
 
+    template <class Expr, std::size_t nLeaves>
+    Matrix &
+    operator+=(const LazyExpr<Expr, nLeaves> & expr);
+
+    template <class Expr, std::size_t nLeaves>
+    Matrix &
+    operator-=(const LazyExpr<Expr, nLeaves> & expr);
+
     template <class U, sp::Int32 nColsOther>
     Matrix<T, mRows, nColsOther>
     operator*(const Matrix<U, nCols, nColsOther> & other) const
@@ -684,12 +784,32 @@ private:
     friend class Matrix;
 
     // Wants to construct matrices from Eigen matrices
-    template <class U, sp::Int32 dim>
+    template <class U, sp::Int32 dim, TransformStorage storage>
     friend class Transformation;
 
+    template <class U>
+    friend class TRSTransformation;
+
+    template <class U>
+    friend class Quaternion;
+
+    template <class Solver>
+    friend class sp::details::Decomposition;
+
+    // Lazy expressions reference the Eigen matrix
+    template <class U, sp::Int32 mRowsOther, sp::Int32 nColsOther>
+    friend LazyExpr<const sp::details::MatrixBase<U, mRowsOther, nColsOther> &, 1>
+    lazy(const Matrix<U, mRowsOther, nColsOther> & mat);
+
     typedef sp::details::MatrixBase<T, mRows, nCols> Mat;
 
-    Matrix(const Mat & mat) : mat{mat} {}
+    // Evaluates Eigen expressions directly in mat
+    template <class Derived>
+    Matrix(const Eigen::MatrixBase<Derived> & expr) : mat{expr}
+    {
+    }
+
+    Matrix(Mat && mat) : mat{std::move(mat)} {}
 
     Mat mat;
 };
@@ -723,8 +843,52 @@ typedef sp::Matrix<float, 2, 2> Mat2;
 typedef sp::Matrix<float, 3, 3> Mat3;
 typedef sp::Matrix<float, 4, 4> Mat4;
 
+typedef sp::Vec<sp::Dynamic> VecX;
+typedef sp::Matrix<float, sp::Dynamic, sp::Dynamic> MatX;
+
+
+////////////////////////////////////////////////////////////
+/// \brief Threads used by products of large (dynamic) matrices
+///
+/// Eigen's products are cache-blocked, they are also split among
+/// threads when spirit-math is built with SPIRIT_MATH_USE_OPENMP.
+/// Without OpenMP, the number of threads is always 1.
+////////////////////////////////////////////////////////////
+inline void
+setNbThreads(sp::Int32 nThreads)
+{
+    Eigen::setNbThreads(nThreads);
+}
+
+inline sp::Int32
+getNbThreads()
+{
+    return Eigen::nbThreads();
+}
+
+
+////////////////////////////////////////////////////////////
+// Common sizes are compiled once, in spirit-math (src/SPIRIT/Instantiation)
+////////////////////////////////////////////////////////////
+
+extern template class Matrix<float, 2, 1>;
+extern template class Matrix<float, 3, 1>;
+extern template class Matrix<float, 4, 1>;
+extern template class Matrix<float, 2, 2>;
+extern template class Matrix<float, 3, 3>;
+extern template class Matrix<float, 4, 4>;
+
+extern template class Matrix<double, 2, 1>;
+extern template class Matrix<double, 3, 1>;
+extern template class Matrix<double, 4, 1>;
+extern template class Matrix<double, 2, 2>;
+extern template class Matrix<double, 3, 3>;
+extern template class Matrix<double, 4, 4>;
+
 
 } // namespace sp
 
 
+#include "SPIRIT/Math/Matrix/Lazy.hpp"
+
 #endif // SPIRIT_MATRIX_HPP
@@ -0,0 +1,117 @@
+////////////////////////////////////////////////////////////
+//
+// Spirit
+// Copyright (C) 2022 Matthieu Beauchamp-Boulay
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it freely,
+// subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+////////////////////////////////////////////////////////////
+
+
+#ifndef SPIRIT_PARALLEL_HPP
+#define SPIRIT_PARALLEL_HPP
+
+#include "SPIRIT/Base.hpp"
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+namespace sp
+{
+
+////////////////////////////////////////////////////////////
+/// \brief Selects how bulk operations are executed
+///
+/// Parallel only spreads the work across threads when there is
+/// enough of it to amortize starting them, smaller inputs run sequentially.
+////////////////////////////////////////////////////////////
+enum class Execution
+{
+    Sequential,
+    Parallel
+};
+
+namespace details
+{
+
+// Minimum number of elements given to each thread.
+constexpr std::size_t parallelGrainSize = 1 << 15;
+
+// Number of threads parallelFor splits size elements across
+inline std::size_t
+threadCount(
+    std::size_t size,
+    sp::Execution execution,
+    std::size_t grainSize = parallelGrainSize
+)
+{
+    if (execution == sp::Execution::Sequential)
+    {
+        return 1;
+    }
+
+    std::size_t hardware = std::max(1u, std::thread::hardware_concurrency());
+    return std::clamp<std::size_t>(size / grainSize, 1, hardware);
+}
+
+////////////////////////////////////////////////////////////
+/// \brief Calls kernel(begin, end) over disjoint ranges covering [0, size)
+///
+/// Every range except the last starts and ends on a multiple of `multiple`
+/// (ie: the batch size of the kernel, so only the last range has a tail).
+/// The calling thread processes the first range.
+////////////////////////////////////////////////////////////
+template <class Kernel>
+void
+parallelFor(
+    std::size_t size,
+    sp::Execution execution,
+    Kernel && kernel,
+    std::size_t multiple  = 1,
+    std::size_t grainSize = parallelGrainSize
+)
+{
+    std::size_t nThreads = threadCount(size, execution, grainSize);
+    if (nThreads == 1)
+    {
+        kernel(std::size_t{0}, size);
+        return;
+    }
+
+    std::size_t chunk = (size + nThreads - 1) / nThreads;
+    chunk             = (chunk + multiple - 1) / multiple * multiple;
+
+    std::vector<std::jthread> workers{};
+    workers.reserve(nThreads - 1);
+    for (std::size_t begin = chunk; begin < size; begin += chunk)
+    {
+        workers.emplace_back([&kernel, begin, end = std::min(begin + chunk, size)]() {
+            kernel(begin, end);
+        });
+    }
+
+    kernel(std::size_t{0}, std::min(chunk, size));
+}
+
+} // namespace details
+
+} // namespace sp
+
+
+#endif // SPIRIT_PARALLEL_HPP
@@ -0,0 +1,556 @@
+////////////////////////////////////////////////////////////
+//
+// Spirit
+// Copyright (C) 2022 Matthieu Beauchamp-Boulay
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it freely,
+// subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+////////////////////////////////////////////////////////////
+
+
+#ifndef SPIRIT_QUATERNION_HPP
+#define SPIRIT_QUATERNION_HPP
+
+#include "SPIRIT/Base.hpp"
+#include "Eigen/Geometry"
+#include "SPIRIT/Math/Batch/Batch.hpp"
+#include "SPIRIT/Math/Matrix/Matrix.hpp"
+#include "SPIRIT/Math/Parallel/Parallel.hpp"
+
+#include <array>
+#include <span>
+
+
+namespace sp
+{
+
+namespace details
+{
+
+// offsets of the lanes of a batch gathering every stride-th value
+template <class T, sp::Int32 stride>
+sp::details::Batch<xsimd::as_integer_t<T>>
+strideIndices()
+{
+    typedef xsimd::as_integer_t<T> Index;
+    typedef sp::details::Batch<Index> IndexBatch;
+    static_assert(IndexBatch::size == sp::details::Batch<T>::size);
+
+    alignas(IndexBatch::arch_type::alignment()) Index offsets[IndexBatch::size];
+    for (std::size_t l = 0; l < IndexBatch::size; ++l)
+    {
+        offsets[l] = static_cast<Index>(l * stride);
+    }
+
+    return IndexBatch::load_aligned(offsets);
+}
+
+// Quaternions split by coefficient (x, y, z, w), one quaternion per lane
+template <class T>
+using QuaternionBatches = std::array<sp::details::Batch<T>, 4>;
+
+template <class T>
+using VectorBatches = std::array<sp::details::Batch<T>, 3>;
+
+// Hamilton product of each lane
+template <class T>
+QuaternionBatches<T>
+multiplyBatches(const QuaternionBatches<T> & a, const QuaternionBatches<T> & b)
+{
+    const auto & [ax, ay, az, aw] = a;
+    const auto & [bx, by, bz, bw] = b;
+
+    return {
+        xsimd::fma(aw, bx, xsimd::fma(ax, bw, xsimd::fms(ay, bz, az * by))),
+        xsimd::fma(aw, by, xsimd::fma(ay, bw, xsimd::fms(az, bx, ax * bz))),
+        xsimd::fma(aw, bz, xsimd::fma(az, bw, xsimd::fms(ax, by, ay * bx))),
+        xsimd::fms(aw, bw, xsimd::fma(ax, bx, xsimd::fma(ay, by, az * bz)))};
+}
+
+// Rotates each lane of v by the unit quaternion of the same lane:
+// v + w * t + q.xyz x t, where t = 2 * q.xyz x v
+template <class T>
+VectorBatches<T>
+rotateBatches(const QuaternionBatches<T> & q, const VectorBatches<T> & v)
+{
+    typedef sp::details::Batch<T> Batch;
+
+    const auto & [qx, qy, qz, qw] = q;
+    const auto & [vx, vy, vz]     = v;
+
+    const Batch two{T{2}};
+    Batch tx = two * xsimd::fms(qy, vz, qz * vy);
+    Batch ty = two * xsimd::fms(qz, vx, qx * vz);
+    Batch tz = two * xsimd::fms(qx, vy, qy * vx);
+
+    return {
+        xsimd::fma(qw, tx, vx) + xsimd::fms(qy, tz, qz * ty),
+        xsimd::fma(qw, ty, vy) + xsimd::fms(qz, tx, qx * tz),
+        xsimd::fma(qw, tz, vz) + xsimd::fms(qx, ty, qy * tx)};
+}
+
+} // namespace details
+
+
+////////////////////////////////////////////////////////////
+/// \brief Rotation in 3D stored as a unit quaternion
+///
+/// Composing rotations costs 16 multiplications instead of the 27 of
+/// 3x3 matrices (64 for the 4x4 matrices of sp::Transformation),
+/// and a quaternion is easily renormalized when rounding errors
+/// accumulate over many compositions.
+///
+/// As with transformations, the product applies the rightmost rotation first:
+/// \code
+/// sp::Quat q = sp::Quat{sp::radians(90.f), {0, 0, 1}} * sp::Quat{sp::radians(45.f), {1, 0, 0}};
+/// sp::Vec3 v = q * sp::Vec3{0, 1, 0}; // around x, then around z
+/// \endcode
+///
+/// Rotations of vectors assume a unit quaternion.
+/// The bulk operations process one quaternion per SIMD lane.
+////////////////////////////////////////////////////////////
+template <class T>
+class Quaternion
+{
+    typedef Eigen::Quaternion<T> Quat;
+    typedef sp::Vector<T, 3> Vector;
+
+    typedef sp::details::Batch<T> Batch;
+
+public:
+
+    // identity
+    Quaternion() : q{Quat::Identity()} {}
+
+    Quaternion(T w, T x, T y, T z) : q{w, x, y, z} {}
+
+    // rotation of radians around axis, axis is assumed to be normalized
+    Quaternion(T radians, const Vector & axis)
+        : q{Eigen::AngleAxis<T>{radians, axis.mat}}
+    {
+    }
+
+    // rotation is assumed to be orthonormal
+    explicit Quaternion(const sp::Matrix<T, 3, 3> & rotation) : q{rotation.mat} {}
+
+    static Quaternion
+    Identity()
+    {
+        return Quaternion{};
+    }
+
+    // Shortest rotation bringing the direction of from onto the direction of to
+    static Quaternion
+    FromTwoVectors(const Vector & from, const Vector & to)
+    {
+        return Quat::FromTwoVectors(from.mat, to.mat);
+    }
+
+
+    T
+    w() const
+    {
+        return q.w();
+    }
+
+    T
+    x() const
+    {
+        return q.x();
+    }
+
+    T
+    y() const
+    {
+        return q.y();
+    }
+
+    T
+    z() const
+    {
+        return q.z();
+    }
+
+    // imaginary part (x, y, z)
+    Vector
+    vec() const
+    {
+        return Vector{q.vec()};
+    }
+
+
+    T
+    norm() const
+    {
+        return q.norm();
+    }
+
+    T
+    dot(const Quaternion & other) const
+    {
+        return q.dot(other.q);
+    }
+
+    // angle of the rotation from this to other
+    T
+    angularDistance(const Quaternion & other) const
+    {
+        return q.angularDistance(other.q);
+    }
+
+    Quaternion
+    normalized() const
+    {
+        return Quat{q.normalized()};
+    }
+
+    Quaternion &
+    normalize()
+    {
+        q.normalize();
+        return *this;
+    }
+
+    // inverse of a unit quaternion
+    Quaternion
+    conjugated() const
+    {
+        return q.conjugate();
+    }
+
+    Quaternion &
+    conjugate()
+    {
+        q = q.conjugate();
+        return *this;
+    }
+
+    Quaternion
+    inversed() const
+    {
+        return q.inverse();
+    }
+
+    Quaternion &
+    inverse()
+    {
+        q = q.inverse();
+        return *this;
+    }
+
+
+    // rotation applying other, then this
+    Quaternion
+    operator*(const Quaternion & other) const
+    {
+        return q * other.q;
+    }
+
+    Quaternion &
+    operator*=(const Quaternion & other)
+    {
+        q *= other.q;
+        return *this;
+    }
+
+    // rotates v
+    Vector
+    operator*(const Vector & v) const
+    {
+        return Vector{q._transformVector(v.mat)};
+    }
+
+    sp::Matrix<T, 3, 3>
+    toMatrix() const
+    {
+        return sp::Matrix<T, 3, 3>{q.toRotationMatrix()};
+    }
+
+
+    // Spherical interpolation, constant angular velocity from this (t = 0) to other (t = 1)
+    Quaternion
+    slerp(const Quaternion & other, T t) const
+    {
+        return q.slerp(t, other.q);
+    }
+
+    // Normalized linear interpolation along the shortest path,
+    // cheaper than slerp but the angular velocity is not constant.
+    Quaternion
+    nlerp(const Quaternion & other, T t) const
+    {
+        T sign = q.dot(other.q) < 0 ? -1 : 1;
+
+        Quat res;
+        res.coeffs() = (1 - t) * q.coeffs() + (sign * t) * other.q.coeffs();
+        res.normalize();
+        return res;
+    }
+
+
+    bool
+    operator==(const Quaternion & other) const
+    {
+        return q.coeffs() == other.q.coeffs();
+    }
+
+    bool
+    operator!=(const Quaternion & other) const
+    {
+        return q.coeffs() != other.q.coeffs();
+    }
+
+    // q and -q are the same rotation, but are not approximately equal
+    bool
+    isApprox(
+        const Quaternion & other,
+        T tolerance = Eigen::NumTraits<T>::dummy_precision()
+    ) const
+    {
+        return q.isApprox(other.q, tolerance);
+    }
+
+
+    ////////////////////////////////////////////////////////////
+    // Bulk operations
+    ////////////////////////////////////////////////////////////
+
+    // res[i] = lhs[i] * rhs[i], res may be lhs or rhs
+    static void
+    multiply(
+        std::span<const Quaternion> lhs,
+        std::span<const Quaternion> rhs,
+        std::span<Quaternion> res,
+        sp::Execution execution = sp::Execution::Sequential
+    )
+    {
+        SPIRIT_ASSERT(lhs.size() == rhs.size() && lhs.size() == res.size())
+
+        const auto indices = sp::details::strideIndices<T, 4>();
+
+        auto kernel = [&](std::size_t begin, std::size_t end) {
+            std::size_t i = begin;
+            for (; i + Batch::size <= end; i += Batch::size)
+            {
+                auto c = sp::details::multiplyBatches<T>(
+                    gather(&lhs[i], indices),
+                    gather(&rhs[i], indices)
+                );
+                scatter(c, &res[i], indices);
+            }
+
+            for (; i < end; ++i)
+            {
+                res[i] = lhs[i] * rhs[i];
+            }
+        };
+
+        sp::details::parallelFor(lhs.size(), execution, kernel, Batch::size);
+    }
+
+    // Normalizes each quaternion of quaternions
+    static void
+    normalize(
+        std::span<Quaternion> quaternions,
+        sp::Execution execution = sp::Execution::Sequential
+    )
+    {
+        const auto indices = sp::details::strideIndices<T, 4>();
+
+        auto kernel = [&](std::size_t begin, std::size_t end) {
+            std::size_t i = begin;
+            for (; i + Batch::size <= end; i += Batch::size)
+            {
+                auto c = gather(&quaternions[i], indices);
+
+                Batch squaredNorm = c[0] * c[0];
+                for (sp::Int32 k = 1; k < 4; ++k)
+                {
+                    squaredNorm = xsimd::fma(c[k], c[k], squaredNorm);
+                }
+
+                Batch invNorm = Batch{T{1}} / xsimd::sqrt(squaredNorm);
+                for (Batch & coeff : c)
+                {
+                    coeff *= invNorm;
+                }
+
+                scatter(c, &quaternions[i], indices);
+            }
+
+            for (; i < end; ++i)
+            {
+                quaternions[i].normalize();
+            }
+        };
+
+        sp::details::parallelFor(quaternions.size(), execution, kernel, Batch::size);
+    }
+
+    // res[i] = rotations[i] * vectors[i], res may be vectors
+    static void
+    rotate(
+        std::span<const Quaternion> rotations,
+        std::span<const Vector> vectors,
+        std::span<Vector> res,
+        sp::Execution execution = sp::Execution::Sequential
+    )
+    {
+        static_assert(
+            sizeof(Vector) == 3 * sizeof(T),
+            "Vectors must be tightly packed"
+        );
+        SPIRIT_ASSERT(rotations.size() == vectors.size() && vectors.size() == res.size())
+
+        const auto quatIndices   = sp::details::strideIndices<T, 4>();
+        const auto vectorIndices = sp::details::strideIndices<T, 3>();
+
+        auto kernel = [&](std::size_t begin, std::size_t end) {
+            std::size_t i = begin;
+            for (; i + Batch::size <= end; i += Batch::size)
+            {
+                const T * src = &vectors[i][0];
+                T * dst       = &res[i][0];
+
+                sp::details::VectorBatches<T> v;
+                for (sp::Int32 k = 0; k < 3; ++k)
+                {
+                    v[k] = Batch::gather(src + k, vectorIndices);
+                }
+
+                v = sp::details::rotateBatches<T>(gather(&rotations[i], quatIndices), v);
+                for (sp::Int32 k = 0; k < 3; ++k)
+                {
+                    v[k].scatter(dst + k, vectorIndices);
+                }
+            }
+
+            for (; i < end; ++i)
+            {
+                res[i] = rotations[i] * vectors[i];
+            }
+        };
+
+        sp::details::parallelFor(vectors.size(), execution, kernel, Batch::size);
+    }
+
+    // Rotates all vectors by this rotation into res, res may be vectors
+    void
+    applyTo(
+        std::span<const Vector> vectors,
+        std::span<Vector> res,
+        sp::Execution execution = sp::Execution::Sequential
+    ) const
+    {
+        static_assert(
+            sizeof(Vector) == 3 * sizeof(T),
+            "Vectors must be tightly packed"
+        );
+        SPIRIT_ASSERT(vectors.size() == res.size())
+
+        const auto indices = sp::details::strideIndices<T, 3>();
+        const sp::details::QuaternionBatches<T> rotation{
+            Batch{q.x()},
+            Batch{q.y()},
+            Batch{q.z()},
+            Batch{q.w()}};
+
+        auto kernel = [&](std::size_t begin, std::size_t end) {
+            std::size_t i = begin;
+            for (; i + Batch::size <= end; i += Batch::size)
+            {
+                const T * src = &vectors[i][0];
+                T * dst       = &res[i][0];
+
+                sp::details::VectorBatches<T> v;
+                for (sp::Int32 k = 0; k < 3; ++k)
+                {
+                    v[k] = Batch::gather(src + k, indices);
+                }
+
+                v = sp::details::rotateBatches<T>(rotation, v);
+                for (sp::Int32 k = 0; k < 3; ++k)
+                {
+                    v[k].scatter(dst + k, indices);
+                }
+            }
+
+            for (; i < end; ++i)
+            {
+                res[i] = *this * vectors[i];
+            }
+        };
+
+        sp::details::parallelFor(vectors.size(), execution, kernel, Batch::size);
+    }
+
+
+private:
+
+    template <class, sp::Int32, TransformStorage>
+    friend class Transformation;
+
+    template <class>
+    friend class TRSTransformation;
+
+    static_assert(
+        sizeof(Quat) == 4 * sizeof(T),
+        "Quaternions must be tightly packed"
+    );
+
+    Quaternion(const Quat & q) : q{q} {}
+
+    // coefficients are stored as (x, y, z, w)
+    static sp::details::QuaternionBatches<T>
+    gather(const Quaternion * src, const sp::details::Batch<xsimd::as_integer_t<T>> & indices)
+    {
+        const T * coeffs = src->q.coeffs().data();
+
+        sp::details::QuaternionBatches<T> c;
+        for (sp::Int32 k = 0; k < 4; ++k)
+        {
+            c[k] = Batch::gather(coeffs + k, indices);
+        }
+
+        return c;
+    }
+
+    static void
+    scatter(
+        const sp::details::QuaternionBatches<T> & c,
+        Quaternion * dst,
+        const sp::details::Batch<xsimd::as_integer_t<T>> & indices
+    )
+    {
+        T * coeffs = dst->q.coeffs().data();
+        for (sp::Int32 k = 0; k < 4; ++k)
+        {
+            c[k].scatter(coeffs + k, indices);
+        }
+    }
+
+    Quat q;
+};
+
+typedef Quaternion<float> Quat;
+typedef Quaternion<double> QuatD;
+
+} // namespace sp
+
+
+#endif // SPIRIT_QUATERNION_HPP
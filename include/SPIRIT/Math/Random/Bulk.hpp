@@ -0,0 +1,407 @@
+////////////////////////////////////////////////////////////
+//
+// Spirit
+// Copyright (C) 2022 Matthieu Beauchamp-Boulay
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it freely,
+// subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+////////////////////////////////////////////////////////////
+
+
+#ifndef SPIRIT_RANDOM_BULK_HPP
+#define SPIRIT_RANDOM_BULK_HPP
+
+#include "SPIRIT/Base.hpp"
+#include "SPIRIT/Math/Batch/Batch.hpp"
+#include "SPIRIT/Math/Random/Pcg.hpp"
+#include "SPIRIT/Math/Random/Philox.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <iterator>
+#include <type_traits>
+
+
+////////////////////////////////////////////////////////////
+// Vectorized generation for RandList.
+//
+// Contiguous ranges of float, double and 32 bits integers are filled
+// a batch at a time: random words are generated in an aligned buffer,
+// then converted with bit manipulations instead of going through
+// the std:: distributions one element at a time.
+//
+// The values differ from the ones the element-wise path would produce,
+// but they are reproducible for a given engine state.
+////////////////////////////////////////////////////////////
+
+namespace sp
+{
+
+namespace details
+{
+
+template <class T, class IterType>
+concept BulkFillable
+    = std::contiguous_iterator<IterType>
+      && std::is_same_v<std::iter_value_t<IterType>, T>
+      && (std::is_same_v<T, float> || std::is_same_v<T, double>
+          || std::is_same_v<T, sp::Int32> || std::is_same_v<T, sp::Uint32>);
+
+
+// The kernels below take the target Arch as their first template parameter
+// so they can be compiled for several instruction sets, see Dispatch.hpp.
+
+template <class Arch = xsimd::default_arch>
+using ArchWordBatch = sp::details::Batch<sp::Uint32, Arch>;
+
+typedef ArchWordBatch<> WordBatch;
+
+// Number of words fillWords produces at once
+template <class Arch = xsimd::default_arch>
+constexpr std::size_t archWordBlockSize = 4 * ArchWordBatch<Arch>::size;
+
+constexpr std::size_t wordBlockSize = archWordBlockSize<>;
+
+
+////////////////////////////////////////////////////////////
+/// \brief fills words with n random 32 bits words
+///
+/// n must be a multiple of archWordBlockSize<Arch> and words must be
+/// aligned for ArchWordBatch<Arch>.
+///
+/// Philox blocks are computed ArchWordBatch<Arch>::size at a time,
+/// one counter per lane.
+////////////////////////////////////////////////////////////
+template <class Arch = xsimd::default_arch>
+void
+fillWords(sp::Philox & engine, sp::Uint32 * words, std::size_t n)
+{
+    typedef ArchWordBatch<Arch> WordBatch;
+    constexpr std::size_t nLanes = WordBatch::size;
+    SPIRIT_ASSERT(n % archWordBlockSize<Arch> == 0)
+
+    alignas(WordBatch::arch_type::alignment()) sp::Uint32 offsets[nLanes];
+    for (std::size_t l = 0; l < nLanes; ++l)
+    {
+        offsets[l] = static_cast<sp::Uint32>(l);
+    }
+    const WordBatch laneOffsets = WordBatch::load_aligned(offsets);
+
+    sp::Philox::Key key = engine.getKey();
+    const std::array<WordBatch, 2> k{WordBatch{key[0]}, WordBatch{key[1]}};
+
+    sp::Philox::Counter ctr = engine.getCounter();
+    for (std::size_t i = 0; i < n; i += archWordBlockSize<Arch>)
+    {
+        WordBatch low   = WordBatch{ctr[0]} + laneOffsets;
+        WordBatch carry = xsimd::select(
+            low < WordBatch{ctr[0]},
+            WordBatch{1},
+            WordBatch{0}
+        );
+
+        std::array<WordBatch, 4> block = sp::Philox::generate<WordBatch>(
+            {low, WordBatch{ctr[1]} + carry, WordBatch{ctr[2]}, WordBatch{ctr[3]}},
+            k
+        );
+
+        for (std::size_t w = 0; w < 4; ++w)
+        {
+            block[w].store_aligned(words + i + w * nLanes);
+        }
+
+        sp::Philox::increment(ctr, nLanes);
+    }
+
+    engine.setCounter(ctr);
+}
+
+// Any other engine with 64 bits outputs is drawn from one output at a time.
+template <class Arch = xsimd::default_arch, class Engine>
+void
+fillWords(Engine & engine, sp::Uint32 * words, std::size_t n)
+{
+    static_assert(
+        Engine::min() == 0
+            && Engine::max() == std::numeric_limits<sp::Uint64>::max(),
+        "Engine must produce 64 bits outputs"
+    );
+
+    for (std::size_t i = 0; i < n; i += 2)
+    {
+        sp::Uint64 bits = engine();
+        words[i]        = static_cast<sp::Uint32>(bits);
+        words[i + 1]    = static_cast<sp::Uint32>(bits >> 32);
+    }
+}
+
+
+////////////////////////////////////////////////////////////
+/// \brief fills [out, out + n) from converted random words
+///
+/// convert(words) must return a Batch<T, Arch> made from the
+/// sizeof(T) / 4 * Batch<T, Arch>::size words at words (aligned).
+////////////////////////////////////////////////////////////
+template <class Arch = xsimd::default_arch, class T, class Engine, class Convert>
+void
+bulkFill(Engine & engine, T * out, std::size_t n, Convert && convert)
+{
+    typedef sp::details::Batch<T, Arch> Values;
+    typedef ArchWordBatch<Arch> WordBatch;
+    static_assert(Values::size * sizeof(T) == WordBatch::size * sizeof(sp::Uint32));
+
+    constexpr std::size_t blockSize     = archWordBlockSize<Arch>;
+    constexpr std::size_t wordsPerValue = sizeof(T) / sizeof(sp::Uint32);
+    constexpr std::size_t bufferSize    = 32 * blockSize;
+    constexpr std::size_t valuesPerFill = bufferSize / wordsPerValue;
+
+    alignas(Arch::alignment()) sp::Uint32 words[bufferSize];
+
+    while (n > 0)
+    {
+        std::size_t count  = std::min(n, valuesPerFill);
+        std::size_t nWords = count * wordsPerValue;
+        nWords = (nWords + blockSize - 1) / blockSize * blockSize;
+        fillWords<Arch>(engine, words, nWords);
+
+        std::size_t i = 0;
+        for (; i + Values::size <= count; i += Values::size)
+        {
+            convert(words + i * wordsPerValue).store_unaligned(out + i);
+        }
+
+        if (i < count)
+        {
+            alignas(Arch::alignment()) T tail[Values::size];
+            convert(words + i * wordsPerValue).store_aligned(tail);
+            std::copy_n(tail, count - i, out + i);
+        }
+
+        out += count;
+        n -= count;
+    }
+}
+
+
+////////////////////////////////////////////////////////////
+/// \brief uniform floats in [a, b)
+///
+/// The mantissa is filled with random bits under the exponent of 1,
+/// giving a float in [1, 2) which is then shifted to [0, 1).
+////////////////////////////////////////////////////////////
+template <class Arch = xsimd::default_arch, class Engine>
+void
+uniformFill(Engine & engine, float * out, std::size_t n, float a, float b)
+{
+    typedef sp::details::Batch<float, Arch> Values;
+    typedef ArchWordBatch<Arch> WordBatch;
+    const Values scale{b - a};
+    const Values offset{a};
+
+    bulkFill<Arch>(engine, out, n, [&](const sp::Uint32 * words) {
+        WordBatch bits = (WordBatch::load_aligned(words) >> 9) | WordBatch{0x3F800000};
+        Values unit = xsimd::bitwise_cast<float>(bits) - Values{1};
+        return xsimd::fma(unit, scale, offset);
+    });
+}
+
+// uniform doubles in [a, b), same as for floats with 52 random bits from 2 words
+template <class Arch = xsimd::default_arch, class Engine>
+void
+uniformFill(Engine & engine, double * out, std::size_t n, double a, double b)
+{
+    typedef sp::details::Batch<double, Arch> Values;
+    typedef sp::details::Batch<sp::Uint64, Arch> Bits;
+    typedef ArchWordBatch<Arch> WordBatch;
+    const Values scale{b - a};
+    const Values offset{a};
+
+    bulkFill<Arch>(engine, out, n, [&](const sp::Uint32 * words) {
+        Bits bits = xsimd::bitwise_cast<sp::Uint64>(WordBatch::load_aligned(words));
+        bits      = (bits >> 12) | Bits{0x3FF0000000000000};
+        Values unit = xsimd::bitwise_cast<double>(bits) - Values{1};
+        return xsimd::fma(unit, scale, offset);
+    });
+}
+
+
+// scalar multiply-shift with rejection, see uniformIntFill
+template <class Engine>
+sp::Uint32
+boundedWord(Engine & engine, sp::Uint32 range, sp::Uint32 threshold)
+{
+    while (true)
+    {
+        sp::Uint64 product = (engine() & 0xFFFFFFFF) * range;
+        if (static_cast<sp::Uint32>(product) >= threshold)
+        {
+            return static_cast<sp::Uint32>(product >> 32);
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////
+/// \brief uniform integer in [0, range), range > 0
+///
+/// Lemire's nearly divisionless multiply-shift on a 64 bits output:
+/// the high half of word * range is uniform once the words whose low
+/// half falls under 2^64 % range are rejected. The modulo is only
+/// computed when the low half is under range, which is rare for
+/// ranges much smaller than 2^64.
+///
+/// Powers of two take the high bits of the word, without rejection.
+////////////////////////////////////////////////////////////
+template <class Engine>
+sp::Uint64
+boundedInt(Engine & engine, sp::Uint64 range)
+{
+    static_assert(
+        Engine::min() == 0
+            && Engine::max() == std::numeric_limits<sp::Uint64>::max(),
+        "Engine must produce 64 bits outputs"
+    );
+    SPIRIT_ASSERT(range > 0)
+
+    if ((range & (range - 1)) == 0)
+    {
+        // two shifts, as shifting by 64 when range is 1 is undefined
+        return (engine() >> 1) >> (63 - std::countr_zero(range));
+    }
+
+    sp::Uint64 word = engine();
+    sp::Uint64 low  = word * range;
+    if (low < range)
+    {
+        const sp::Uint64 threshold = (0 - range) % range;
+        while (low < threshold)
+        {
+            word = engine();
+            low  = word * range;
+        }
+    }
+
+    return sp::details::mulhi64(word, range);
+}
+
+////////////////////////////////////////////////////////////
+/// \brief uniform integer of any integer type in [a, b]
+////////////////////////////////////////////////////////////
+template <class T, class Engine>
+T
+uniformInt(Engine & engine, T a, T b)
+{
+    static_assert(
+        std::is_integral_v<T> && !std::is_same_v<T, bool>,
+        "Must be an integer"
+    );
+    typedef std::make_unsigned_t<T> U;
+    SPIRIT_ASSERT(a <= b)
+
+    sp::Uint64 span = static_cast<U>(static_cast<U>(b) - static_cast<U>(a));
+    sp::Uint64 offset = span == std::numeric_limits<sp::Uint64>::max()
+                            ? engine()
+                            : boundedInt(engine, span + 1);
+
+    return static_cast<T>(static_cast<U>(static_cast<U>(a) + static_cast<U>(offset)));
+}
+
+////////////////////////////////////////////////////////////
+/// \brief uniform 32 bits integers in [a, b]
+///
+/// Lemire's multiply-shift: the high word of word * range is uniform
+/// in [0, range) once the few words whose low product falls under
+/// 2^32 % range are rejected. Rejected lanes are rare and redrawn
+/// one at a time.
+///
+/// Powers of two are the high bits of the words, without any
+/// multiplication or rejection.
+///
+/// Lemire, "Fast Random Integer Generation in an Interval" (2019)
+////////////////////////////////////////////////////////////
+template <class Arch = xsimd::default_arch, class T, class Engine>
+void
+uniformIntFill(Engine & engine, T * out, std::size_t n, T a, T b)
+{
+    static_assert(sizeof(T) == sizeof(sp::Uint32));
+    typedef ArchWordBatch<Arch> WordBatch;
+
+    const sp::Uint32 range = static_cast<sp::Uint32>(b) - static_cast<sp::Uint32>(a) + 1;
+    const WordBatch offset{static_cast<sp::Uint32>(a)};
+
+    if (range == 0) // [a, b] covers all 32 bits values
+    {
+        bulkFill<Arch>(engine, out, n, [&](const sp::Uint32 * words) {
+            return xsimd::bitwise_cast<T>(WordBatch::load_aligned(words));
+        });
+        return;
+    }
+
+    if ((range & (range - 1)) == 0)
+    {
+        if (range == 1)
+        {
+            std::fill_n(out, n, a);
+            return;
+        }
+
+        const sp::Int32 shift = 32 - std::countr_zero(range);
+        bulkFill<Arch>(engine, out, n, [&](const sp::Uint32 * words) {
+            return xsimd::bitwise_cast<T>((WordBatch::load_aligned(words) >> shift) + offset);
+        });
+        return;
+    }
+
+    const sp::Uint32 threshold = (0u - range) % range;
+    const WordBatch ranges{range};
+    const WordBatch thresholds{threshold};
+
+    bulkFill<Arch>(engine, out, n, [&](const sp::Uint32 * words) {
+        WordBatch low;
+        WordBatch high = sp::details::mulhilo(WordBatch::load_aligned(words), ranges, low);
+
+        auto rejected = low < thresholds;
+        if (xsimd::any(rejected))
+        {
+            alignas(Arch::alignment()) sp::Uint32 values[WordBatch::size];
+            high.store_aligned(values);
+
+            sp::Uint64 mask = rejected.mask();
+            for (std::size_t l = 0; l < WordBatch::size; ++l)
+            {
+                if ((mask >> l) & 1)
+                {
+                    values[l] = boundedWord(engine, range, threshold);
+                }
+            }
+
+            high = WordBatch::load_aligned(values);
+        }
+
+        return xsimd::bitwise_cast<T>(high + offset);
+    });
+}
+
+// compiled once in spirit-math, see Philox::generate
+extern template sp::Uint32
+boundedWord(sp::Philox & engine, sp::Uint32 range, sp::Uint32 threshold);
+
+} // namespace details
+
+} // namespace sp
+
+#endif // SPIRIT_RANDOM_BULK_HPP
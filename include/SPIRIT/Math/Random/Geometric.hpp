@@ -0,0 +1,265 @@
+////////////////////////////////////////////////////////////
+//
+// Spirit
+// Copyright (C) 2022 Matthieu Beauchamp-Boulay
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it freely,
+// subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+////////////////////////////////////////////////////////////
+
+
+
+#ifndef SPIRIT_RANDOM_GEOMETRIC_HPP
+#define SPIRIT_RANDOM_GEOMETRIC_HPP
+
+#include "SPIRIT/Base.hpp"
+#include "SPIRIT/Math/Batch/Batch.hpp"
+#include "SPIRIT/Math/Dispatch/Dispatch.hpp"
+
+#include <algorithm>
+#include <array>
+#include <iterator>
+#include <numbers>
+#include <type_traits>
+
+
+////////////////////////////////////////////////////////////
+// Uniform points on and in simple shapes for RandList.
+//
+// Each shape is an exact mapping of uniform values in [0, 1) to the shape,
+// there is no rejection loop: every point costs the same few square roots
+// and one sincos, computed a SIMD batch at a time.
+//
+// Points are generated by chunks: the uniform values of a chunk are drawn
+// in bulk, mapped to coordinates stored by coordinate, then written
+// to the destination one point at a time.
+////////////////////////////////////////////////////////////
+
+namespace sp
+{
+
+template <class T>
+class Quaternion;
+
+
+namespace details
+{
+
+template <class Value>
+struct GeometricScalar
+{
+    typedef std::remove_cvref_t<decltype(std::declval<const Value &>()[0])> type;
+};
+
+template <class T>
+struct GeometricScalar<sp::Quaternion<T>>
+{
+    typedef T type;
+};
+
+// Scalar type of the points or rotations of a range
+template <class IterType>
+using GeometricScalar_t =
+    typename GeometricScalar<std::remove_cvref_t<std::iter_value_t<IterType>>>::type;
+
+
+////////////////////////////////////////////////////////////
+// Mappings of uniform batches u, v, w in [0, 1)
+////////////////////////////////////////////////////////////
+
+// uniform in the unit disk: radius sqrt(u), angle 2 pi v
+template <class Batch>
+std::array<Batch, 2>
+diskPoints(const Batch & u, const Batch & v)
+{
+    typedef typename Batch::value_type T;
+
+    auto [sin, cos] = xsimd::sincos(Batch{2 * std::numbers::pi_v<T>} * v);
+    Batch radius    = xsimd::sqrt(u);
+    return {radius * cos, radius * sin};
+}
+
+// uniform on the unit sphere: z uniform in (-1, 1] (Archimedes), angle 2 pi v
+template <class Batch>
+std::array<Batch, 3>
+spherePoints(const Batch & u, const Batch & v)
+{
+    typedef typename Batch::value_type T;
+    const Batch one{T{1}};
+    const Batch two{T{2}};
+
+    // sqrt(1 - z^2) without the cancellation of 1 - z^2 near the poles
+    Batch z      = xsimd::fnma(two, u, one);
+    Batch radius = two * xsimd::sqrt(u * (one - u));
+
+    auto [sin, cos] = xsimd::sincos(Batch{2 * std::numbers::pi_v<T>} * v);
+    return {radius * cos, radius * sin, z};
+}
+
+// uniform in the unit ball: a direction on the sphere, at radius cbrt(w)
+template <class Batch>
+std::array<Batch, 3>
+ballPoints(const Batch & u, const Batch & v, const Batch & w)
+{
+    std::array<Batch, 3> p = spherePoints(u, v);
+    Batch radius           = xsimd::cbrt(w);
+    for (Batch & coord : p)
+    {
+        coord *= radius;
+    }
+
+    return p;
+}
+
+// Cosine-weighted directions around +z (Malley):
+// a point of the unit disk lifted onto the hemisphere
+template <class Batch>
+std::array<Batch, 3>
+cosineHemispherePoints(const Batch & u, const Batch & v)
+{
+    typedef typename Batch::value_type T;
+
+    auto [x, y] = diskPoints(u, v);
+    return {x, y, xsimd::sqrt(Batch{T{1}} - u)};
+}
+
+// Uniform unit quaternions as (x, y, z, w)
+//
+// Shoemake, "Uniform Random Rotations", Graphics Gems III (1992)
+template <class Batch>
+std::array<Batch, 4>
+rotationPoints(const Batch & u, const Batch & v, const Batch & w)
+{
+    typedef typename Batch::value_type T;
+    const Batch twoPi{2 * std::numbers::pi_v<T>};
+
+    Batch a = xsimd::sqrt(Batch{T{1}} - u);
+    Batch b = xsimd::sqrt(u);
+
+    auto [sin1, cos1] = xsimd::sincos(twoPi * v);
+    auto [sin2, cos2] = xsimd::sincos(twoPi * w);
+    return {a * sin1, a * cos1, b * sin2, b * cos2};
+}
+
+
+////////////////////////////////////////////////////////////
+/// \brief fills [begin, end) with mapped uniform values
+///
+/// map takes nUniforms batches of uniform values in [0, 1) and returns
+/// an std::array of coordinate batches. make(coords, stride) builds
+/// a point from the coordinates at coords, coords + stride, ...
+////////////////////////////////////////////////////////////
+template <class T, std::size_t nUniforms, class Engine, class IterType, class Map, class Make>
+void
+geometricFill(Engine & engine, IterType begin, IterType end, Map && map, Make && make)
+{
+    typedef sp::details::Batch<T> Values;
+    constexpr std::size_t chunkSize = 32 * Values::size;
+    constexpr std::size_t nCoords
+        = std::tuple_size_v<decltype(map(std::declval<std::array<Values, nUniforms>>()))>;
+
+    alignas(Values::arch_type::alignment()) T uniforms[nUniforms * chunkSize];
+    alignas(Values::arch_type::alignment()) T coords[nCoords * chunkSize];
+
+    std::size_t n = static_cast<std::size_t>(std::distance(begin, end));
+    while (n > 0)
+    {
+        std::size_t count  = std::min(n, chunkSize);
+        std::size_t padded = (count + Values::size - 1) / Values::size * Values::size;
+        dispatchUniform(engine, uniforms, nUniforms * padded, T{0}, T{1});
+
+        for (std::size_t i = 0; i < padded; i += Values::size)
+        {
+            std::array<Values, nUniforms> u;
+            for (std::size_t k = 0; k < nUniforms; ++k)
+            {
+                u[k] = Values::load_aligned(uniforms + k * padded + i);
+            }
+
+            auto p = map(u);
+            for (std::size_t c = 0; c < nCoords; ++c)
+            {
+                p[c].store_aligned(coords + c * chunkSize + i);
+            }
+        }
+
+        for (std::size_t i = 0; i < count; ++i, ++begin)
+        {
+            *begin = make(coords + i, chunkSize);
+        }
+
+        n -= count;
+    }
+}
+
+// Fills a range of 2D or 3D vectors with the points of map
+template <std::size_t nUniforms, class Engine, class IterType, class Map>
+void
+vectorFill(Engine & engine, IterType begin, IterType end, Map && map)
+{
+    typedef std::remove_cvref_t<std::iter_value_t<IterType>> Vector;
+    typedef GeometricScalar_t<IterType> T;
+    typedef sp::details::Batch<T> Values;
+
+    constexpr std::size_t dim
+        = std::tuple_size_v<decltype(map(std::declval<std::array<Values, nUniforms>>()))>;
+    static_assert(sizeof(Vector) == dim * sizeof(T), "Vectors of the wrong dimension");
+
+    geometricFill<T, nUniforms>(
+        engine,
+        begin,
+        end,
+        map,
+        [](const T * coords, std::size_t stride) {
+            if constexpr (dim == 2)
+            {
+                return Vector{coords[0], coords[stride]};
+            }
+            else
+            {
+                return Vector{coords[0], coords[stride], coords[2 * stride]};
+            }
+        }
+    );
+}
+
+// Fills a range of quaternions with uniform random rotations
+template <class Engine, class IterType>
+void
+rotationFill(Engine & engine, IterType begin, IterType end)
+{
+    typedef std::remove_cvref_t<std::iter_value_t<IterType>> Rotation;
+    typedef GeometricScalar_t<IterType> T;
+
+    geometricFill<T, 3>(
+        engine,
+        begin,
+        end,
+        [](const auto & u) { return rotationPoints(u[0], u[1], u[2]); },
+        [](const T * coords, std::size_t stride) {
+            return Rotation{coords[3 * stride], coords[0], coords[stride], coords[2 * stride]};
+        }
+    );
+}
+
+} // namespace details
+
+} // namespace sp
+
+
+#endif // SPIRIT_RANDOM_GEOMETRIC_HPP
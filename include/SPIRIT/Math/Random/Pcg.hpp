@@ -0,0 +1,229 @@
+////////////////////////////////////////////////////////////
+//
+// Spirit
+// Copyright (C) 2022 Matthieu Beauchamp-Boulay
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it freely,
+// subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+////////////////////////////////////////////////////////////
+
+
+
+#ifndef SPIRIT_PCG_HPP
+#define SPIRIT_PCG_HPP
+
+#include "SPIRIT/Base.hpp"
+
+#include <limits>
+
+
+namespace sp
+{
+
+namespace details
+{
+
+#if defined(__SIZEOF_INT128__)
+// __extension__ keeps -Wpedantic quiet about the non standard type
+__extension__ typedef unsigned __int128 Uint128Native;
+#endif
+
+// high 64 bits of a * b
+inline sp::Uint64
+mulhi64(sp::Uint64 a, sp::Uint64 b)
+{
+#if defined(__SIZEOF_INT128__)
+    return static_cast<sp::Uint64>((static_cast<Uint128Native>(a) * b) >> 64);
+#else
+    sp::Uint64 aLow  = a & 0xFFFFFFFF;
+    sp::Uint64 aHigh = a >> 32;
+    sp::Uint64 bLow  = b & 0xFFFFFFFF;
+    sp::Uint64 bHigh = b >> 32;
+
+    sp::Uint64 lowLow  = aLow * bLow;
+    sp::Uint64 lowHigh = aLow * bHigh;
+    sp::Uint64 highLow = aHigh * bLow;
+
+    sp::Uint64 carry = ((lowLow >> 32) + (lowHigh & 0xFFFFFFFF) + (highLow & 0xFFFFFFFF)) >> 32;
+    return aHigh * bHigh + (lowHigh >> 32) + (highLow >> 32) + carry;
+#endif
+}
+
+// Unsigned 128 bits integer, only what the PCG engine needs
+struct Uint128
+{
+    sp::Uint64 high;
+    sp::Uint64 low;
+
+    friend Uint128
+    operator+(const Uint128 & a, const Uint128 & b)
+    {
+        sp::Uint64 low = a.low + b.low;
+        return {a.high + b.high + (low < a.low), low};
+    }
+
+    friend Uint128
+    operator*(const Uint128 & a, const Uint128 & b)
+    {
+        return {
+            mulhi64(a.low, b.low) + a.high * b.low + a.low * b.high,
+            a.low * b.low};
+    }
+
+    bool
+    operator==(const Uint128 & other) const = default;
+};
+
+} // namespace details
+
+
+//////////////////////////////////////////////////////////
+///
+/// \brief PCG64 random engine (XSL RR 128/64)
+///
+/// From O'Neill, "PCG: A Family of Simple Fast Space-Efficient
+/// Statistically Good Algorithms for Random Number Generation" (2014).
+///
+/// A 128 bits linear congruential generator whose high bits are permuted
+/// into 64 bits outputs, with a period of 2^128 per stream.
+///
+/// Each stream uses its own increment of the LCG, seed(seed, stream)
+/// matches pcg64_srandom_r(seed, stream) of the reference implementation.
+/// Positions can be reached in logarithmic time: jump() advances by 2^64
+/// outputs and longJump() by 2^96.
+///
+/// Satisfies the UniformRandomBitGenerator requirements with 64 bits outputs.
+///
+//////////////////////////////////////////////////////////
+class Pcg64
+{
+public:
+
+    typedef sp::Uint64 result_type;
+
+    typedef sp::details::Uint128 Word;
+
+    constexpr static Word multiplier{0x2360ED051FC65DA4, 0x4385DF649FCCF645};
+
+    constexpr static result_type defaultSeed = 0x5EED;
+
+    explicit Pcg64(result_type seed = defaultSeed, result_type stream = 0)
+    {
+        this->seed(seed, stream);
+    }
+
+    void
+    seed(result_type seed, result_type stream = 0)
+    {
+        increment = {stream >> 63, (stream << 1) | 1};
+        state     = {0, 0};
+        step();
+        state = state + Word{0, seed};
+        step();
+    }
+
+    result_type
+    operator()()
+    {
+        step();
+
+        // xor of the halves, rotated by the top 6 bits
+        sp::Uint64 folded   = state.high ^ state.low;
+        sp::Int32 rotation = static_cast<sp::Int32>(state.high >> 58);
+        return (folded >> rotation) | (folded << ((64 - rotation) & 63));
+    }
+
+    // Advances the engine by n outputs in logarithmic time
+    void
+    discard(unsigned long long n)
+    {
+        advance({0, n});
+    }
+
+    // Advances the engine by 2^64 outputs
+    void
+    jump()
+    {
+        advance({1, 0});
+    }
+
+    // Advances the engine by 2^96 outputs
+    void
+    longJump()
+    {
+        advance({sp::Uint64{1} << 32, 0});
+    }
+
+    constexpr static result_type
+    min()
+    {
+        return 0;
+    }
+
+    constexpr static result_type
+    max()
+    {
+        return std::numeric_limits<result_type>::max();
+    }
+
+    bool
+    operator==(const Pcg64 & other) const = default;
+
+private:
+
+    void
+    step()
+    {
+        state = state * multiplier + increment;
+    }
+
+    // Brown, "Random Number Generation with Arbitrary Strides" (1994):
+    // n steps of the LCG compose into a single multiply-add.
+    void
+    advance(Word n)
+    {
+        Word accMultiplier{0, 1};
+        Word accIncrement{0, 0};
+        Word curMultiplier = multiplier;
+        Word curIncrement  = increment;
+
+        while (n.high != 0 || n.low != 0)
+        {
+            if (n.low & 1)
+            {
+                accMultiplier = accMultiplier * curMultiplier;
+                accIncrement  = accIncrement * curMultiplier + curIncrement;
+            }
+
+            curIncrement  = (curMultiplier + Word{0, 1}) * curIncrement;
+            curMultiplier = curMultiplier * curMultiplier;
+
+            n = {n.high >> 1, (n.low >> 1) | (n.high << 63)};
+        }
+
+        state = accMultiplier * state + accIncrement;
+    }
+
+    Word state;
+    Word increment;
+};
+
+} // namespace sp
+
+
+#endif // SPIRIT_PCG_HPP
@@ -0,0 +1,317 @@
+////////////////////////////////////////////////////////////
+//
+// Spirit
+// Copyright (C) 2022 Matthieu Beauchamp-Boulay
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it freely,
+// subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+////////////////////////////////////////////////////////////
+
+
+#ifndef SPIRIT_PHILOX_HPP
+#define SPIRIT_PHILOX_HPP
+
+#include "SPIRIT/Base.hpp"
+#include "SPIRIT/Math/Batch/Batch.hpp"
+
+#include <array>
+#include <limits>
+#include <utility>
+
+
+namespace sp
+{
+
+//////////////////////////////////////////////////////////
+///
+/// \brief Philox4x32-10 counter-based random engine
+///
+/// From Salmon et al., "Parallel Random Numbers: As Easy as 1, 2, 3" (2011).
+///
+/// Each output is a pure function of (seed, stream, position), the engine
+/// only holds a key and a counter. Any number of independent and reproducible
+/// streams can be derived from one seed without sharing any state,
+/// which makes it suitable for per-thread or per-task generators.
+///
+/// Satisfies the UniformRandomBitGenerator requirements with 64 bits outputs,
+/// so it can be used with the std:: distributions.
+///
+/// <code>
+/// // each worker gets its own reproducible stream
+/// sp::Philox engine{seed, workerIndex};
+/// std::uniform_real_distribution<float> dist{0, 1};
+/// float f = dist(engine);
+/// </code>
+///
+//////////////////////////////////////////////////////////
+class Philox
+{
+public:
+
+    typedef sp::Uint64 result_type;
+
+    typedef std::array<sp::Uint32, 4> Counter;
+    typedef std::array<sp::Uint32, 2> Key;
+
+    constexpr static sp::Int32 rounds = 10;
+
+    constexpr static sp::Uint32 multiplier0 = 0xD2511F53;
+    constexpr static sp::Uint32 multiplier1 = 0xCD9E8D57;
+    constexpr static sp::Uint32 weyl0       = 0x9E3779B9;
+    constexpr static sp::Uint32 weyl1       = 0xBB67AE85;
+
+    constexpr static result_type defaultSeed = 0x5EED;
+
+
+    //////////////////////////////////////////////////////////
+    ///
+    /// \brief Engine at the start of a stream
+    ///
+    /// \param seed Selects the key, shared by related streams
+    /// \param stream Selects an independent sequence for this seed
+    ///
+    //////////////////////////////////////////////////////////
+    explicit Philox(result_type seed = defaultSeed, result_type stream = 0)
+    {
+        this->seed(seed, stream);
+    }
+
+    void
+    seed(result_type seed, result_type stream = 0)
+    {
+        key     = {lowWord(seed), highWord(seed)};
+        counter = {0, 0, lowWord(stream), highWord(stream)};
+        index   = outputsPerBlock;
+    }
+
+    result_type
+    operator()()
+    {
+        if (index == outputsPerBlock)
+        {
+            block  = generate(counter, key);
+            index  = 0;
+            increment(counter, 1);
+        }
+
+        result_type res = (result_type{block[2 * index + 1]} << 32) | block[2 * index];
+        ++index;
+        return res;
+    }
+
+    // Advances the engine by n outputs in constant time
+    void
+    discard(unsigned long long n)
+    {
+        sp::Uint64 buffered = outputsPerBlock - index;
+        if (n <= buffered)
+        {
+            index += static_cast<sp::Int32>(n);
+            return;
+        }
+
+        n -= buffered;
+        increment(counter, n / outputsPerBlock);
+        index = outputsPerBlock;
+
+        sp::Int32 remaining = static_cast<sp::Int32>(n % outputsPerBlock);
+        if (remaining != 0)
+        {
+            (*this)();
+            index = remaining;
+        }
+    }
+
+    constexpr static result_type
+    min()
+    {
+        return 0;
+    }
+
+    constexpr static result_type
+    max()
+    {
+        return std::numeric_limits<result_type>::max();
+    }
+
+    bool
+    operator==(const Philox & other) const
+    {
+        return key == other.key && position() == other.position();
+    }
+
+    //////////////////////////////////////////////////////////
+    ///
+    /// \brief The Philox4x32-10 bijection
+    ///
+    /// The engine outputs generate({n, stream}, key) for n = 0, 1, 2, ...
+    /// Generic over the word type so it can run on sp::details::Batch
+    /// (see details::mulhilo).
+    ///
+    //////////////////////////////////////////////////////////
+    template <class Word>
+    static std::array<Word, 4>
+    generate(std::array<Word, 4> ctr, std::array<Word, 2> k);
+
+    static Counter
+    generate(Counter ctr, Key k)
+    {
+        return generate<sp::Uint32>(ctr, k);
+    }
+
+    Key
+    getKey() const
+    {
+        return key;
+    }
+
+    // Counter of the next block to be generated
+    Counter
+    getCounter() const
+    {
+        return counter;
+    }
+
+    // Moves to the start of the block at counter, discarding buffered outputs.
+    void
+    setCounter(const Counter & ctr)
+    {
+        counter = ctr;
+        index   = outputsPerBlock;
+    }
+
+    // Adds n to the block index of ctr (the stream is left untouched)
+    static void
+    increment(Counter & ctr, sp::Uint64 n)
+    {
+        sp::Uint64 low = ((sp::Uint64{ctr[1]} << 32) | ctr[0]) + n;
+        ctr[0]         = lowWord(low);
+        ctr[1]         = highWord(low);
+    }
+
+private:
+
+    constexpr static sp::Int32 outputsPerBlock = 2;
+
+    constexpr static sp::Uint32
+    lowWord(sp::Uint64 x)
+    {
+        return static_cast<sp::Uint32>(x);
+    }
+
+    constexpr static sp::Uint32
+    highWord(sp::Uint64 x)
+    {
+        return static_cast<sp::Uint32>(x >> 32);
+    }
+
+    std::pair<Counter, sp::Int32>
+    position() const
+    {
+        return {counter, index};
+    }
+
+    Key key;
+    Counter counter;
+    Counter block{};
+    sp::Int32 index = outputsPerBlock;
+};
+
+
+namespace details
+{
+
+// returns the high 32 bits of a * b and sets lo to the low 32 bits.
+inline sp::Uint32
+mulhilo(sp::Uint32 a, sp::Uint32 b, sp::Uint32 & lo)
+{
+    sp::Uint64 product = sp::Uint64{a} * b;
+    lo                 = static_cast<sp::Uint32>(product);
+    return static_cast<sp::Uint32>(product >> 32);
+}
+
+// Vectorized mulhilo, there is no widening 32 bits multiplication
+// for every arch so the high word is assembled from 16 bits halves.
+template <class Arch>
+sp::details::Batch<sp::Uint32, Arch>
+mulhilo(
+    const sp::details::Batch<sp::Uint32, Arch> & a,
+    const sp::details::Batch<sp::Uint32, Arch> & b,
+    sp::details::Batch<sp::Uint32, Arch> & lo
+)
+{
+    typedef sp::details::Batch<sp::Uint32, Arch> Word;
+    const Word mask{0xFFFF};
+
+    Word aLow  = a & mask;
+    Word aHigh = a >> 16;
+    Word bLow  = b & mask;
+    Word bHigh = b >> 16;
+
+    Word lowLow   = aLow * bLow;
+    Word lowHigh  = aLow * bHigh;
+    Word highLow  = aHigh * bLow;
+    Word highHigh = aHigh * bHigh;
+
+    Word carry = ((lowLow >> 16) + (lowHigh & mask) + (highLow & mask)) >> 16;
+
+    lo = a * b;
+    return highHigh + (lowHigh >> 16) + (highLow >> 16) + carry;
+}
+
+} // namespace details
+
+
+template <class Word>
+std::array<Word, 4>
+Philox::generate(std::array<Word, 4> ctr, std::array<Word, 2> k)
+{
+    using sp::details::mulhilo;
+
+    for (sp::Int32 r = 0; r < rounds; ++r)
+    {
+        if (r != 0)
+        {
+            k[0] += Word{weyl0};
+            k[1] += Word{weyl1};
+        }
+
+        Word lo0, lo1;
+        Word hi0 = mulhilo(ctr[0], Word{multiplier0}, lo0);
+        Word hi1 = mulhilo(ctr[2], Word{multiplier1}, lo1);
+
+        ctr = {hi1 ^ ctr[1] ^ k[0], lo1, hi0 ^ ctr[3] ^ k[1], lo0};
+    }
+
+    return ctr;
+}
+
+
+////////////////////////////////////////////////////////////
+// The scalar block is compiled once, in spirit-math (src/SPIRIT/Instantiation),
+// so the units built for other instruction sets (src/SPIRIT/Dispatch)
+// never provide a copy of it.
+////////////////////////////////////////////////////////////
+
+extern template std::array<sp::Uint32, 4>
+Philox::generate<sp::Uint32>(std::array<sp::Uint32, 4> ctr, std::array<sp::Uint32, 2> k);
+
+} // namespace sp
+
+
+#endif // SPIRIT_PHILOX_HPP
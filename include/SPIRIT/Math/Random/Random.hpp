@@ -27,26 +27,82 @@
 #define SPIRIT_RANDOM_HPP
 
 #include "SPIRIT/Base.hpp"
+#include "SPIRIT/Math/Parallel/Parallel.hpp"
+#include "SPIRIT/Math/Random/Pcg.hpp"
+#include "SPIRIT/Math/Random/Philox.hpp"
+#include "SPIRIT/Math/Random/SplitMix.hpp"
+#include "SPIRIT/Math/Random/Xoshiro.hpp"
+#include <iterator>
 #include <random>
 
 
 namespace sp
 {
 
+template <class E>
+class BasicRandList;
+
+
 //////////////////////////////////////////////////////////
 ///
 /// \brief static class to return single Random numbers
 ///
+/// Every thread draws from its own engine, there is no shared state.
+/// By default, each thread gets a distinct stream of a seed chosen
+/// at startup. Use seed(seed, stream) in each thread (or task) to get
+/// reproducible results.
+///
+/// sp::Random uses sp::Philox, other engines can be chosen with
+/// BasicRandom<Engine>, for example sp::Xoshiro256 for faster scalar draws
+/// or smaller per thread states. Engines must have 64 bits outputs
+/// and be constructible from (seed, stream).
+///
+/// \tparam E Engine (UniformRandomBitGenerator with 64 bits outputs)
+///
 //////////////////////////////////////////////////////////
-class Random
+template <class E>
+class BasicRandom
 {
 public:
 
+    typedef E Engine;
+
+    //////////////////////////////////////////////////////////
+    ///
+    /// \brief reseeds the calling thread's engine non-deterministically
+    ///
     //////////////////////////////////////////////////////////
     static void
     seed();
 
 
+    //////////////////////////////////////////////////////////
+    ///
+    /// \brief reseeds the calling thread's engine
+    ///
+    /// Workers using the same seed with distinct stream ids
+    /// produce independent and reproducible sequences.
+    ///
+    /// \param seed Seed shared by all the streams
+    /// \param stream Id of the stream for the calling thread
+    ///
+    //////////////////////////////////////////////////////////
+    static void
+    seed(sp::Uint64 seed, sp::Uint64 stream = 0);
+
+
+    //////////////////////////////////////////////////////////
+    ///
+    /// \brief the calling thread's engine
+    ///
+    /// Can be copied to hand a stream to a task,
+    /// or assigned to resume one.
+    ///
+    //////////////////////////////////////////////////////////
+    static Engine &
+    engine();
+
+
     //////////////////////////////////////////////////////////
     ///
     /// \brief Return a random number
@@ -90,6 +146,9 @@ public:
     /// Shorthand function for picking an Integer type number
     /// between 0 and nChoices-1 using uniform distribution
     ///
+    /// Uses Lemire's multiply-shift, which almost never divides,
+    /// and only shifts when nChoices is a power of two.
+    ///
     /// \tparam T Integer Type of the return value
     ///
     /// \param nChoices Range of the distribution (positive)
@@ -134,6 +193,8 @@ public:
         /// Takes an Integer type T and returns a T value in the
         /// interval [a, b] using uniform distribution
         ///
+        /// Same method as choose(), see sp::details::boundedInt
+        ///
         /// \tparam T integer Type to be used
         ///
         /// \param a minimal value
@@ -172,6 +233,9 @@ public:
     ///
     /// \brief Gaussian Distributions for random numbers
     ///
+    /// float and double values are sampled with the Ziggurat method,
+    /// see sp::details::Ziggurat.
+    ///
     //////////////////////////////////////////////////////////
     class Gauss
     {
@@ -184,7 +248,7 @@ public:
         /// Takes an Integer type T and returns a T value
         /// according to a Gaussian distribution.
         ///
-        /// Uses floats internally
+        /// Uses floats internally, rounded to the nearest integer
         ///
         /// \tparam T Integer type
         ///
@@ -255,7 +319,7 @@ public:
         //////////////////////////////////////////////////////////
         template <typename returnType = sp::Uint32, typename weightType = double>
         static returnType
-        randInt(std::vector<weightType> weights);
+        randInt(const std::vector<weightType> & weights);
     };
 
 
@@ -265,12 +329,16 @@ protected:
     ///
     /// \brief Internal generator for all random number generations
     ///
+    /// One per thread, each starting on its own stream.
+    ///
     //////////////////////////////////////////////////////////
-    static std::mt19937_64 generator;
+    static thread_local Engine generator;
 
-    friend class RandList;
+    friend class BasicRandList<E>;
 };
 
+typedef BasicRandom<sp::Philox> Random;
+
 
 // ///////////////////////////////////////////////////////
 
@@ -287,9 +355,27 @@ protected:
 ///
 /// \brief static class for populating containers with random numbers
 ///
+/// Uniform distributions (random, choose, Uni::) over contiguous ranges of
+/// float, double, sp::Int32 or sp::Uint32 are generated a SIMD batch at a
+/// time, as well as Gauss:: over contiguous float, double or sp::Int32.
+/// Other ranges are populated one element at a time.
+///
+/// Points in shapes (onSphere, inBall, inDisk, cosineHemisphere) and
+/// rotations are mapped from uniform values without rejection, a SIMD
+/// batch at a time, into any range of sp::Vector or sp::Quaternion.
+///
+/// shuffle and permutation can run in parallel, sampleWithoutReplacement
+/// draws distinct indices. See sp::ReservoirSampler for streams.
+///
+/// sp::RandList draws from sp::Random's engines, BasicRandList<Engine>
+/// from the ones of BasicRandom<Engine>.
+///
 //////////////////////////////////////////////////////////
-class RandList
+template <class E>
+class BasicRandList
 {
+    typedef BasicRandom<E> Random;
+
 public:
 
     //////////////////////////////////////////////////////////
@@ -399,6 +485,239 @@ public:
     random(IterType begin, IterType end);
 
 
+    //////////////////////////////////////////////////////////
+    ///
+    /// \brief fill a container with low-discrepancy points
+    ///
+    /// Populates the container with the next points of sequence,
+    /// one of the quasi-random sequences of SPIRIT/Math/Random/Sequence.hpp
+    /// (sp::SobolSequence, sp::HaltonSequence, sp::R2Sequence).
+    /// The container holds either sp::Vector<T, dim> points or their
+    /// interleaved float / double coordinates.
+    ///
+    /// The sequence is deterministic, scramble it with a seed
+    /// drawn from the engine to randomize it:
+    ///
+    /// <code>
+    /// sp::SobolSequence<2> sobol{sp::Scrambling::Owen, sp::Random::engine()()};\n
+    /// std::vector<sp::Vec2> samples(256);\n
+    /// sp::RandList::quasiRandom(sobol, samples);\n
+    /// </code>
+    ///
+    /// \param sequence Sequence to draw the points from, advanced
+    ///                 by the number of points
+    /// \param receiver container to be populated
+    ///
+    //////////////////////////////////////////////////////////
+    template <class Sequence, class container>
+    static void
+    quasiRandom(Sequence & sequence, container & receiver);
+
+
+    //////////////////////////////////////////////////////////
+    ///
+    /// \brief fill a range with low-discrepancy points
+    ///
+    /// Same as above for [begin, end)
+    ///
+    //////////////////////////////////////////////////////////
+    template <class Sequence, typename IterType>
+    static void
+    quasiRandom(Sequence & sequence, IterType begin, IterType end);
+
+
+    //////////////////////////////////////////////////////////
+    ///
+    /// \brief fill a container with points on the unit sphere
+    ///
+    /// Populates a container of 3D vectors (sp::Vector<float or double>)
+    /// with points uniformly distributed on the unit sphere.
+    ///
+    /// \param receiver container to be populated
+    ///
+    //////////////////////////////////////////////////////////
+    template <class container>
+    static void
+    onSphere(container & receiver);
+
+    // same as above for [begin, end)
+    template <typename IterType>
+    static void
+    onSphere(IterType begin, IterType end);
+
+
+    //////////////////////////////////////////////////////////
+    ///
+    /// \brief fill a container with points in the unit ball
+    ///
+    /// Populates a container of 3D vectors (sp::Vector<float or double>)
+    /// with points uniformly distributed inside the unit ball.
+    ///
+    /// \param receiver container to be populated
+    ///
+    //////////////////////////////////////////////////////////
+    template <class container>
+    static void
+    inBall(container & receiver);
+
+    // same as above for [begin, end)
+    template <typename IterType>
+    static void
+    inBall(IterType begin, IterType end);
+
+
+    //////////////////////////////////////////////////////////
+    ///
+    /// \brief fill a container with points in the unit disk
+    ///
+    /// Populates a container of 2D vectors (sp::Vector<float or double>)
+    /// with points uniformly distributed inside the unit disk.
+    ///
+    /// \param receiver container to be populated
+    ///
+    //////////////////////////////////////////////////////////
+    template <class container>
+    static void
+    inDisk(container & receiver);
+
+    // same as above for [begin, end)
+    template <typename IterType>
+    static void
+    inDisk(IterType begin, IterType end);
+
+
+    //////////////////////////////////////////////////////////
+    ///
+    /// \brief fill a container with cosine-weighted directions
+    ///
+    /// Populates a container of 3D vectors (sp::Vector<float or double>)
+    /// with points of the unit hemisphere around +z, with a density proportional
+    /// to the cosine of their angle with +z (Lambertian reflection).
+    ///
+    /// \param receiver container to be populated
+    ///
+    //////////////////////////////////////////////////////////
+    template <class container>
+    static void
+    cosineHemisphere(container & receiver);
+
+    // same as above for [begin, end)
+    template <typename IterType>
+    static void
+    cosineHemisphere(IterType begin, IterType end);
+
+
+    //////////////////////////////////////////////////////////
+    ///
+    /// \brief fill a container with random rotations
+    ///
+    /// Populates a container of sp::Quaternion<float or double> with
+    /// unit quaternions uniformly distributed over the rotations
+    /// (Shoemake's method).
+    ///
+    /// \param receiver container to be populated
+    ///
+    //////////////////////////////////////////////////////////
+    template <class container>
+    static void
+    rotation(container & receiver);
+
+    // same as above for [begin, end)
+    template <typename IterType>
+    static void
+    rotation(IterType begin, IterType end);
+
+
+    //////////////////////////////////////////////////////////
+    ///
+    /// \brief shuffle a container
+    ///
+    /// Puts the elements in a uniformly random order, in place.
+    /// The container must provide random access iterators.
+    ///
+    /// Ranges larger than the cache are shuffled with MergeShuffle
+    /// (see SPIRIT/Math/Random/Shuffle.hpp), which avoids the cache miss
+    /// per element of std::shuffle. With sp::Execution::Parallel, its
+    /// blocks and merges are spread across threads. The result only
+    /// depends on the engine's state, not on the execution.
+    ///
+    /// \param receiver container to be shuffled
+    /// \param execution Sequential or Parallel
+    ///
+    //////////////////////////////////////////////////////////
+    template <class container>
+    static void
+    shuffle(container & receiver, sp::Execution execution = sp::Execution::Sequential);
+
+    // same as above for [begin, end)
+    template <typename IterType>
+    static void
+    shuffle(
+        IterType begin,
+        IterType end,
+        sp::Execution execution = sp::Execution::Sequential
+    );
+
+
+    //////////////////////////////////////////////////////////
+    ///
+    /// \brief fill a container with a random permutation
+    ///
+    /// Populates a container of n integers with a uniformly random
+    /// permutation of 0 to n-1. Faster than filling the indices and
+    /// shuffling them, each block is built and shuffled in one pass.
+    ///
+    /// <code>
+    /// std::vector<sp::Uint32> order(buffer.size());\n
+    /// sp::RandList::permutation(order, sp::Execution::Parallel);\n
+    /// </code>
+    ///
+    /// \param receiver container to be populated (random access)
+    /// \param execution Sequential or Parallel, see shuffle()
+    ///
+    //////////////////////////////////////////////////////////
+    template <class container>
+    static void
+    permutation(container & receiver, sp::Execution execution = sp::Execution::Sequential);
+
+    // same as above for [begin, end)
+    template <typename IterType>
+    static void
+    permutation(
+        IterType begin,
+        IterType end,
+        sp::Execution execution = sp::Execution::Sequential
+    );
+
+
+    //////////////////////////////////////////////////////////
+    ///
+    /// \brief fill a container with distinct random integers
+    ///
+    /// Populates a container of k elements with k distinct integers
+    /// between 0 and n-1, in random order. Every subset (and order)
+    /// is equally likely.
+    ///
+    /// Uses a partial Fisher-Yates shuffle: over all the indices when
+    /// k is a large part of n, otherwise over a hash map of the few
+    /// displaced indices, in O(k) time and memory whatever n is.
+    ///
+    /// \tparam T Integer type
+    ///
+    /// \param n Number of values to choose from, at least k
+    /// \param receiver container to be populated
+    ///
+    //////////////////////////////////////////////////////////
+    template <typename T = sp::Uint32, class container = std::vector<T>>
+    static void
+    sampleWithoutReplacement(T n, container & receiver);
+
+    // same as above for [begin, end)
+    template <typename T = sp::Uint32, typename IterType>
+    static void
+    sampleWithoutReplacement(T n, IterType begin, IterType end);
+
+
     //////////////////////////////////////////////////////////
     ///
     /// \brief fill a container with random integers
@@ -697,10 +1016,245 @@ public:
             typename weightType = double,
             class container     = std::vector<valType>>
         static void
-        randInt(std::vector<weightType> weights, container & receiver);
+        randInt(const std::vector<weightType> & weights, container & receiver);
     };
 };
 
+typedef BasicRandList<sp::Philox> RandList;
+
+
+//////////////////////////////////////////////////////////
+///
+/// \brief Reusable weighted distribution for random integers
+///
+/// Returns integers in the interval 0 to weights.size()-1 with
+/// probability = weight / (sum of weights), like Random::Weighted.
+///
+/// The weights are preprocessed once into alias tables (Walker, Vose),
+/// after which each draw costs one random word and two table lookups,
+/// regardless of the number of weights.
+///
+/// Weights can be modified in place with setWeight(), the tables are
+/// rebuilt in O(n) on the next draw, reusing their storage.
+/// Prefer this to rebuilding a sampler when weights change a little
+/// every frame.
+///
+/// <code>
+/// sp::WeightedSampler<> loot{0.7, 0.2, 0.1};\n
+/// sp::Uint32 item = loot();\n
+/// std::vector<sp::Uint32> drops(1000);\n
+/// loot.sample(drops);\n
+/// </code>
+///
+/// \tparam valType Integer type to be returned
+/// \tparam weightType Type of the weights, must be
+///                     convertible to double
+///
+//////////////////////////////////////////////////////////
+template <typename valType = sp::Uint32, typename weightType = double>
+class WeightedSampler
+{
+public:
+
+    WeightedSampler() = default;
+
+    WeightedSampler(std::initializer_list<weightType> weights);
+
+    explicit WeightedSampler(const std::vector<weightType> & weights);
+
+    template <typename IterType>
+    WeightedSampler(IterType begin, IterType end);
+
+
+    //////////////////////////////////////////////////////////
+    ///
+    /// \brief replaces all the weights
+    ///
+    //////////////////////////////////////////////////////////
+    template <typename IterType>
+    void
+    setWeights(IterType begin, IterType end);
+
+
+    //////////////////////////////////////////////////////////
+    ///
+    /// \brief changes a single weight
+    ///
+    /// The tables are rebuilt lazily, any number of weights
+    /// can be updated for the cost of one rebuild.
+    ///
+    //////////////////////////////////////////////////////////
+    void
+    setWeight(std::size_t index, weightType weight);
+
+    weightType
+    weight(std::size_t index) const;
+
+    std::size_t
+    size() const;
+
+
+    //////////////////////////////////////////////////////////
+    ///
+    /// \brief draws one value using the calling thread's engine
+    ///
+    //////////////////////////////////////////////////////////
+    valType
+    operator()();
+
+    //////////////////////////////////////////////////////////
+    ///
+    /// \brief draws one value from engine
+    ///
+    /// \tparam Engine UniformRandomBitGenerator with at least 32 bits outputs
+    ///
+    //////////////////////////////////////////////////////////
+    template <class Engine>
+    valType
+    operator()(Engine & engine);
+
+
+    //////////////////////////////////////////////////////////
+    ///
+    /// \brief fill a container with weighted random integers
+    ///
+    /// Contiguous ranges of 32 bits integers are drawn a SIMD batch at a time.
+    ///
+    /// \tparam container iterable container type
+    ///         ( begin(), end(), iterator++ )
+    ///
+    //////////////////////////////////////////////////////////
+    template <class container>
+    void
+    sample(container & receiver);
+
+    template <typename IterType>
+    void
+    sample(IterType begin, IterType end);
+
+    // same as above, drawing from engine
+    template <class Engine, typename IterType>
+    void
+    sample(Engine & engine, IterType begin, IterType end);
+
+private:
+
+    void
+    rebuild();
+
+    // index if the low word is under its threshold, otherwise its alias
+    valType
+    select(sp::Uint32 word) const;
+
+    std::vector<weightType> weights{};
+    double total = 0;
+
+    // probability of keeping each index, scaled to 2^32
+    std::vector<sp::Uint32> thresholds{};
+    std::vector<sp::Uint32> aliases{};
+
+    // rebuild() workspace
+    std::vector<double> scaled{};
+    std::vector<sp::Uint32> small{};
+    std::vector<sp::Uint32> large{};
+
+    bool dirty = false;
+};
+
+
+//////////////////////////////////////////////////////////
+///
+/// \brief Uniform sample of a stream of unknown length
+///
+/// Keeps capacity items of all the items added so far, each of them
+/// with the same probability, in O(capacity) memory.
+///
+/// Uses Li's Algorithm L: after the reservoir is full, the number of
+/// items to skip before the next replacement is drawn directly, so
+/// most items cost a counter increment, and ranges with random access
+/// iterators jump over the skipped items without reading them.
+///
+/// <code>
+/// sp::ReservoirSampler<Transition> replay{1024};\n
+/// for (const Transition & t : episode)\n
+///     replay.add(t);\n
+/// train(replay.sample());\n
+/// </code>
+///
+/// Li, "Reservoir-Sampling Algorithms of Time Complexity
+/// O(n(1 + log(N/n)))" (1994)
+///
+/// \tparam T Type of the items
+///
+//////////////////////////////////////////////////////////
+template <typename T>
+class ReservoirSampler
+{
+public:
+
+    explicit ReservoirSampler(std::size_t capacity);
+
+
+    //////////////////////////////////////////////////////////
+    ///
+    /// \brief adds an item of the stream
+    ///
+    /// Draws from the calling thread's engine, see the overloads
+    /// taking an engine.
+    ///
+    //////////////////////////////////////////////////////////
+    void
+    add(const T & item);
+
+    template <class Engine>
+    void
+    add(Engine & engine, const T & item);
+
+
+    //////////////////////////////////////////////////////////
+    ///
+    /// \brief adds the items of [begin, end) to the stream
+    ///
+    //////////////////////////////////////////////////////////
+    template <std::input_iterator IterType>
+    void
+    add(IterType begin, IterType end);
+
+    template <class Engine, std::input_iterator IterType>
+    void
+    add(Engine & engine, IterType begin, IterType end);
+
+
+    // the kept items, in no particular order
+    const std::vector<T> &
+    sample() const;
+
+    std::size_t
+    capacity() const;
+
+    // number of items added since construction or clear()
+    sp::Uint64
+    seen() const;
+
+    void
+    clear();
+
+private:
+
+    // draws the position of the next replacement
+    template <class Engine>
+    void
+    skip(Engine & engine);
+
+    std::vector<T> items{};
+    std::size_t maxItems;
+    sp::Uint64 count = 0;
+
+    // 1 based position of the next item to keep, once full
+    sp::Uint64 next = 0;
+    double w        = 1;
+};
+
 
 } // namespace sp
 
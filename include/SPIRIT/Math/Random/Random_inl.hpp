@@ -27,25 +27,82 @@
 #define SPIRIT_RANDOM_INL_HPP
 
 
+#include <atomic>
+#include <cmath>
+#include <numeric>
 #include <type_traits>
+#include <unordered_map>
 
 #include "Random.hpp"
+#include "SPIRIT/Math/Dispatch/Dispatch.hpp"
+#include "SPIRIT/Math/Random/Bulk.hpp"
+#include "SPIRIT/Math/Random/Geometric.hpp"
+#include "SPIRIT/Math/Random/Shuffle.hpp"
+#include "SPIRIT/Math/Random/Ziggurat.hpp"
 
 
 namespace sp
 {
 
-std::mt19937_64 Random::generator = std::mt19937_64{std::random_device{}()};
+namespace details
+{
+
+inline sp::Uint64
+randomSeed()
+{
+    std::random_device device{};
+    return (sp::Uint64{device()} << 32) | device();
+}
+
+// Seed of the default streams, chosen once per process
+inline sp::Uint64
+processSeed()
+{
+    static const sp::Uint64 seed = randomSeed();
+    return seed;
+}
+
+// Each thread takes the next stream when it first uses its engine
+inline sp::Uint64
+nextStream()
+{
+    static std::atomic<sp::Uint64> stream{0};
+    return stream.fetch_add(1, std::memory_order_relaxed);
+}
 
+} // namespace details
+
+
+template <class E>
+thread_local E BasicRandom<E>::generator{
+    sp::details::processSeed(),
+    sp::details::nextStream()};
+
+template <class E>
 void
-Random::seed()
+BasicRandom<E>::seed()
 {
-    generator.seed(std::random_device()());
+    generator.seed(sp::details::randomSeed());
 }
 
+template <class E>
+void
+BasicRandom<E>::seed(sp::Uint64 seed, sp::Uint64 stream)
+{
+    generator.seed(seed, stream);
+}
 
+template <class E>
+E &
+BasicRandom<E>::engine()
+{
+    return generator;
+}
+
+
+template <class E>
 bool
-Random::coin(double p)
+BasicRandom<E>::coin(double p)
 {
     std::bernoulli_distribution dist{p};
     return dist(generator);
@@ -95,9 +152,10 @@ using Integer_t = typename Integer<T>::type;
 
 
 // ///////////////////////////////////////////////////////
+template <class E>
 template <typename T, class distrib>
 T
-Random::random_impl(T a, T b)
+BasicRandom<E>::random_impl(T a, T b)
 {
     distrib dist{a, b};
     return dist(generator);
@@ -105,68 +163,77 @@ Random::random_impl(T a, T b)
 
 
 // ///////////////////////////////////////////////////////
+template <class E>
 template <typename T>
 T
-Random::random()
+BasicRandom<E>::random()
 {
-    return Uni::randFloat<T>(0, 1);
+    return Uni::template randFloat<T>(0, 1);
 }
 
 
 // ///////////////////////////////////////////////////////
+template <class E>
 template <typename T>
 T
-Random::choose(T nChoices)
+BasicRandom<E>::choose(T nChoices)
 {
-    typedef sp::details::Integer_t<T> U;
-
-    return random_impl<U, std::uniform_int_distribution<U>>(0, nChoices - 1);
+    return sp::details::uniformInt<T>(generator, 0, nChoices - 1);
 }
 
 
 // ///////////////////////////////////////////////////////
+template <class E>
 template <typename T>
 T
-Random::Uni::randInt(T a, T b)
+BasicRandom<E>::Uni::randInt(T a, T b)
 {
-    typedef sp::details::Integer_t<T> U;
-
-    return random_impl<U, std::uniform_int_distribution<U>>(a, b);
+    return sp::details::uniformInt(generator, a, b);
 }
 
 
 // ///////////////////////////////////////////////////////
+template <class E>
 template <typename T>
 T
-Random::Uni::randFloat(T a, T b)
+BasicRandom<E>::Uni::randFloat(T a, T b)
 {
     return random_impl<T, std::uniform_real_distribution<T>>(a, b);
 }
 
 
 // ///////////////////////////////////////////////////////
+template <class E>
 template <typename T>
 T
-Random::Gauss::randInt(T mean, T stdDev)
+BasicRandom<E>::Gauss::randInt(T mean, T stdDev)
 {
-    return (T
-    )std::round(Random::Gauss::randFloat<float>((float)mean, (float)stdDev));
+    return (T)std::round(Gauss::randFloat<float>((float)mean, (float)stdDev));
 }
 
 
 // ///////////////////////////////////////////////////////
+template <class E>
 template <typename T>
 T
-Random::Gauss::randFloat(T mean, T stdDev)
+BasicRandom<E>::Gauss::randFloat(T mean, T stdDev)
 {
-    return random_impl<T, std::normal_distribution<T>>(mean, stdDev);
+    if constexpr (std::is_same_v<T, float> || std::is_same_v<T, double>)
+    {
+        return mean + stdDev * sp::details::Ziggurat<T>::instance()(generator);
+    }
+    else
+    {
+        return random_impl<T, std::normal_distribution<T>>(mean, stdDev);
+    }
 }
 
 
 // ///////////////////////////////////////////////////////
+template <class E>
 template <typename returnType, typename weightType>
 returnType
-Random::Weighted::randInt(std::vector<weightType> weights)
+BasicRandom<E>::Weighted::randInt(const std::vector<weightType> & weights)
 {
     typedef sp::details::Integer_t<returnType> U;
     SPIRIT_ASSERT(weights.size() + 1 <= std::numeric_limits<returnType>::max())
@@ -177,9 +244,10 @@ Random::Weighted::randInt(std::vector<weightType> weights)
 
 
 // ///////////////////////////////////////////////////////
+template <class E>
 template <typename Type, class distrib, class container>
 void
-RandList::random_Impl(Type a, Type b, container & receiver)
+BasicRandList<E>::random_Impl(Type a, Type b, container & receiver)
 {
     distrib dist{a, b};
     auto it = receiver.begin();
@@ -193,9 +261,10 @@ RandList::random_Impl(Type a, Type b, container & receiver)
 
 
 // ///////////////////////////////////////////////////////
+template <class E>
 template <typename Type, typename IterType, class distrib>
 void
-RandList::random_Impl(Type a, Type b, IterType begin, IterType end)
+BasicRandList<E>::random_Impl(Type a, Type b, IterType begin, IterType end)
 {
     distrib dist{a, b};
 
@@ -209,58 +278,303 @@ RandList::random_Impl(Type a, Type b, IterType begin, IterType end)
 
 
 // ///////////////////////////////////////////////////////
+template <class E>
 template <typename T, class container>
 void
-RandList::random(container & receiver)
+BasicRandList<E>::random(container & receiver)
 {
-    random_Impl<T, std::uniform_real_distribution<T>, container>(0, 1, receiver);
+    random<T>(receiver.begin(), receiver.end());
 }
 
 
 // ///////////////////////////////////////////////////////
+template <class E>
 template <typename T, typename IterType>
 void
-RandList::random(IterType begin, IterType end)
+BasicRandList<E>::random(IterType begin, IterType end)
 {
-    random_Impl<T, IterType, std::uniform_real_distribution<T>>(0, 1, begin, end);
+    Uni::template randFloat<T>(0, 1, begin, end);
 }
 
 
 // ///////////////////////////////////////////////////////
-template <typename T, class container>
+template <class E>
+template <class Sequence, class container>
+void
+BasicRandList<E>::quasiRandom(Sequence & sequence, container & receiver)
+{
+    quasiRandom(sequence, receiver.begin(), receiver.end());
+}
+
+
+// ///////////////////////////////////////////////////////
+template <class E>
+template <class Sequence, typename IterType>
+void
+BasicRandList<E>::quasiRandom(Sequence & sequence, IterType begin, IterType end)
+{
+    sequence.fill(begin, end);
+}
+
+
+// ///////////////////////////////////////////////////////
+template <class E>
+template <class container>
+void
+BasicRandList<E>::onSphere(container & receiver)
+{
+    onSphere(receiver.begin(), receiver.end());
+}
+
+
+// ///////////////////////////////////////////////////////
+template <class E>
+template <typename IterType>
+void
+BasicRandList<E>::onSphere(IterType begin, IterType end)
+{
+    sp::details::vectorFill<2>(Random::generator, begin, end, [](const auto & u) {
+        return sp::details::spherePoints(u[0], u[1]);
+    });
+}
+
+
+// ///////////////////////////////////////////////////////
+template <class E>
+template <class container>
 void
-RandList::choose(T nChoices, container & receiver)
+BasicRandList<E>::inBall(container & receiver)
 {
-    typedef sp::details::Integer_t<T> U;
+    inBall(receiver.begin(), receiver.end());
+}
+
+
+// ///////////////////////////////////////////////////////
+template <class E>
+template <typename IterType>
+void
+BasicRandList<E>::inBall(IterType begin, IterType end)
+{
+    sp::details::vectorFill<3>(Random::generator, begin, end, [](const auto & u) {
+        return sp::details::ballPoints(u[0], u[1], u[2]);
+    });
+}
+
+
+// ///////////////////////////////////////////////////////
+template <class E>
+template <class container>
+void
+BasicRandList<E>::inDisk(container & receiver)
+{
+    inDisk(receiver.begin(), receiver.end());
+}
+
+
+// ///////////////////////////////////////////////////////
+template <class E>
+template <typename IterType>
+void
+BasicRandList<E>::inDisk(IterType begin, IterType end)
+{
+    sp::details::vectorFill<2>(Random::generator, begin, end, [](const auto & u) {
+        return sp::details::diskPoints(u[0], u[1]);
+    });
+}
+
+
+// ///////////////////////////////////////////////////////
+template <class E>
+template <class container>
+void
+BasicRandList<E>::cosineHemisphere(container & receiver)
+{
+    cosineHemisphere(receiver.begin(), receiver.end());
+}
+
+
+// ///////////////////////////////////////////////////////
+template <class E>
+template <typename IterType>
+void
+BasicRandList<E>::cosineHemisphere(IterType begin, IterType end)
+{
+    sp::details::vectorFill<2>(Random::generator, begin, end, [](const auto & u) {
+        return sp::details::cosineHemispherePoints(u[0], u[1]);
+    });
+}
+
+
+// ///////////////////////////////////////////////////////
+template <class E>
+template <class container>
+void
+BasicRandList<E>::rotation(container & receiver)
+{
+    rotation(receiver.begin(), receiver.end());
+}
 
-    random_Impl<U, std::uniform_int_distribution<U>, container>(
-        0,
-        nChoices - 1,
-        receiver
+
+// ///////////////////////////////////////////////////////
+template <class E>
+template <typename IterType>
+void
+BasicRandList<E>::rotation(IterType begin, IterType end)
+{
+    sp::details::rotationFill(Random::generator, begin, end);
+}
+
+
+// ///////////////////////////////////////////////////////
+template <class E>
+template <class container>
+void
+BasicRandList<E>::shuffle(container & receiver, sp::Execution execution)
+{
+    shuffle(receiver.begin(), receiver.end(), execution);
+}
+
+
+// ///////////////////////////////////////////////////////
+template <class E>
+template <typename IterType>
+void
+BasicRandList<E>::shuffle(IterType begin, IterType end, sp::Execution execution)
+{
+    static_assert(
+        std::random_access_iterator<IterType>,
+        "Shuffling needs random access iterators"
+    );
+
+    sp::details::mergeShuffle(
+        Random::generator,
+        begin,
+        end,
+        execution,
+        [](E & engine, IterType first, IterType last) {
+            sp::details::fisherYates(engine, first, last);
+        }
     );
 }
 
 
 // ///////////////////////////////////////////////////////
-template <typename T, typename IterType>
+template <class E>
+template <class container>
 void
-RandList::choose(T nChoices, IterType begin, IterType end)
+BasicRandList<E>::permutation(container & receiver, sp::Execution execution)
 {
-    typedef sp::details::Integer_t<T> U;
+    permutation(receiver.begin(), receiver.end(), execution);
+}
 
-    random_Impl<U, IterType, std::uniform_int_distribution<U>>(
-        0,
-        nChoices - 1,
+
+// ///////////////////////////////////////////////////////
+template <class E>
+template <typename IterType>
+void
+BasicRandList<E>::permutation(IterType begin, IterType end, sp::Execution execution)
+{
+    static_assert(
+        std::random_access_iterator<IterType>,
+        "Permutations need random access iterators"
+    );
+
+    // each block holds the indices of its own positions before merging
+    sp::details::mergeShuffle(
+        Random::generator,
         begin,
-        end
+        end,
+        execution,
+        [begin](E & engine, IterType first, IterType last) {
+            sp::details::insideOut(
+                engine,
+                first,
+                last,
+                static_cast<std::size_t>(first - begin)
+            );
+        }
     );
 }
 
 
 // ///////////////////////////////////////////////////////
+template <class E>
 template <typename T, class container>
 void
-RandList::coin(container & receiver, double p)
+BasicRandList<E>::sampleWithoutReplacement(T n, container & receiver)
+{
+    sampleWithoutReplacement<T>(n, receiver.begin(), receiver.end());
+}
+
+
+// ///////////////////////////////////////////////////////
+template <class E>
+template <typename T, typename IterType>
+void
+BasicRandList<E>::sampleWithoutReplacement(T n, IterType begin, IterType end)
+{
+    const sp::Uint64 size = static_cast<sp::Uint64>(n);
+    const sp::Uint64 k    = static_cast<sp::Uint64>(std::distance(begin, end));
+    SPIRIT_ASSERT(k <= size)
+
+    if (size <= 4 * k)
+    {
+        std::vector<T> indices(size);
+        std::iota(indices.begin(), indices.end(), T{0});
+
+        for (sp::Uint64 i = 0; i < k; ++i, ++begin)
+        {
+            sp::Uint64 j = i + sp::details::boundedInt(Random::generator, size - i);
+            std::swap(indices[i], indices[j]);
+            *begin = indices[i];
+        }
+    }
+    else
+    {
+        // indices swapped away from their position, the others are in place
+        std::unordered_map<sp::Uint64, sp::Uint64> displaced{};
+        displaced.reserve(k);
+        auto at = [&](sp::Uint64 index) {
+            auto it = displaced.find(index);
+            return it == displaced.end() ? index : it->second;
+        };
+
+        for (sp::Uint64 i = 0; i < k; ++i, ++begin)
+        {
+            sp::Uint64 j = i + sp::details::boundedInt(Random::generator, size - i);
+            sp::Uint64 value = at(j);
+            displaced[j]     = at(i);
+            *begin           = static_cast<T>(value);
+        }
+    }
+}
+
+
+// ///////////////////////////////////////////////////////
+template <class E>
+template <typename T, class container>
+void
+BasicRandList<E>::choose(T nChoices, container & receiver)
+{
+    choose<T>(nChoices, receiver.begin(), receiver.end());
+}
+
+
+// ///////////////////////////////////////////////////////
+template <class E>
+template <typename T, typename IterType>
+void
+BasicRandList<E>::choose(T nChoices, IterType begin, IterType end)
+{
+    Uni::template randInt<T>(0, nChoices - 1, begin, end);
+}
+
+
+// ///////////////////////////////////////////////////////
+template <class E>
+template <typename T, class container>
+void
+BasicRandList<E>::coin(container & receiver, double p)
 {
     std::bernoulli_distribution dist{p};
     auto it = receiver.begin();
@@ -274,9 +588,10 @@ RandList::coin(container & receiver, double p)
 
 
 // ///////////////////////////////////////////////////////
+template <class E>
 template <typename T, typename IterType>
 void
-RandList::coin(IterType begin, IterType end, double p)
+BasicRandList<E>::coin(IterType begin, IterType end, double p)
 {
     std::bernoulli_distribution dist{p};
     auto it = begin;
@@ -290,111 +605,551 @@ RandList::coin(IterType begin, IterType end, double p)
 
 
 // ///////////////////////////////////////////////////////
+template <class E>
 template <typename T, class container>
 void
-RandList::Uni::randInt(T a, T b, container & receiver)
+BasicRandList<E>::Uni::randInt(T a, T b, container & receiver)
 {
-    typedef sp::details::Integer_t<T> U;
-
-    random_Impl<U, std::uniform_int_distribution<U>, container>(a, b, receiver);
+    randInt<T>(a, b, receiver.begin(), receiver.end());
 }
 
 
 // ///////////////////////////////////////////////////////
+template <class E>
 template <typename T, typename IterType>
 void
-RandList::Uni::randInt(T a, T b, IterType begin, IterType end)
+BasicRandList<E>::Uni::randInt(T a, T b, IterType begin, IterType end)
 {
-    typedef sp::details::Integer_t<T> U;
-
-    random_Impl<U, IterType, std::uniform_int_distribution<U>>(a, b, begin, end);
+    if constexpr (sp::details::BulkFillable<T, IterType>)
+    {
+        sp::details::dispatchUniform(
+            Random::generator,
+            std::to_address(begin),
+            end - begin,
+            a,
+            b
+        );
+    }
+    else
+    {
+        for (auto it = begin; it != end; ++it)
+        {
+            *it = sp::details::uniformInt(Random::generator, a, b);
+        }
+    }
 }
 
 
 // ///////////////////////////////////////////////////////
+template <class E>
 template <typename T, class container>
 void
-RandList::Uni::randFloat(T a, T b, container & receiver)
+BasicRandList<E>::Uni::randFloat(T a, T b, container & receiver)
 {
-    random_Impl<T, std::uniform_real_distribution<T>, container>(a, b, receiver);
+    randFloat<T>(a, b, receiver.begin(), receiver.end());
 }
 
 
 // ///////////////////////////////////////////////////////
+template <class E>
 template <typename T, typename IterType>
 void
-RandList::Uni::randFloat(T a, T b, IterType begin, IterType end)
+BasicRandList<E>::Uni::randFloat(T a, T b, IterType begin, IterType end)
 {
-    random_Impl<T, IterType, std::uniform_real_distribution<T>>(a, b, begin, end);
+    if constexpr (sp::details::BulkFillable<T, IterType>)
+    {
+        sp::details::dispatchUniform(
+            Random::generator,
+            std::to_address(begin),
+            end - begin,
+            a,
+            b
+        );
+    }
+    else
+    {
+        random_Impl<T, IterType, std::uniform_real_distribution<T>>(a, b, begin, end);
+    }
 }
 
 
 // ///////////////////////////////////////////////////////
+template <class E>
 template <typename T, class container>
 void
-RandList::Gauss::randInt(T mean, T stdDev, container & receiver)
+BasicRandList<E>::Gauss::randInt(T mean, T stdDev, container & receiver)
 {
-    std::normal_distribution<float> dist{(float)mean, (float)stdDev};
-    auto it = receiver.begin();
-
-    while (it != receiver.end())
-    {
-        *it = (T)round(dist(Random::generator));
-        ++it;
-    }
+    randInt<T>(mean, stdDev, receiver.begin(), receiver.end());
 }
 
 
 // ///////////////////////////////////////////////////////
+template <class E>
 template <typename T, typename IterType>
 void
-RandList::Gauss::randInt(T mean, T stdDev, IterType begin, IterType end)
+BasicRandList<E>::Gauss::randInt(T mean, T stdDev, IterType begin, IterType end)
 {
-    std::normal_distribution<float> dist{(float)mean, (float)stdDev};
-    auto it = begin;
-
-    while (it != end)
+    if constexpr (sp::details::BulkFillable<T, IterType> && std::is_same_v<T, sp::Int32>)
     {
-        *it = (T)round(dist(Random::generator));
-        ++it;
+        sp::details::dispatchGaussRounded(
+            Random::generator,
+            std::to_address(begin),
+            end - begin,
+            (float)mean,
+            (float)stdDev
+        );
+    }
+    else
+    {
+        for (auto it = begin; it != end; ++it)
+        {
+            *it = Random::Gauss::template randInt<T>(mean, stdDev);
+        }
     }
 }
 
 
 // ///////////////////////////////////////////////////////
+template <class E>
 template <typename T, class container>
 void
-RandList::Gauss::randFloat(T mean, T stdDev, container & receiver)
+BasicRandList<E>::Gauss::randFloat(T mean, T stdDev, container & receiver)
 {
-    random_Impl<T, std::normal_distribution<T>, container>(mean, stdDev, receiver);
+    randFloat<T>(mean, stdDev, receiver.begin(), receiver.end());
 }
 
 
 // ///////////////////////////////////////////////////////
+template <class E>
 template <typename T, typename IterType>
 void
-RandList::Gauss::randFloat(T mean, T stdDev, IterType begin, IterType end)
+BasicRandList<E>::Gauss::randFloat(T mean, T stdDev, IterType begin, IterType end)
 {
-    random_Impl<T, IterType, std::normal_distribution<T>>(mean, stdDev, begin, end);
+    if constexpr (sp::details::BulkFillable<T, IterType> && std::is_floating_point_v<T>)
+    {
+        sp::details::dispatchGauss(
+            Random::generator,
+            std::to_address(begin),
+            end - begin,
+            mean,
+            stdDev
+        );
+    }
+    else
+    {
+        for (auto it = begin; it != end; ++it)
+        {
+            *it = Random::Gauss::template randFloat<T>(mean, stdDev);
+        }
+    }
 }
 
 
 // ///////////////////////////////////////////////////////
+template <class E>
 template <typename valType, typename weightType, class container>
 void
-RandList::Weighted::randInt(std::vector<weightType> weights, container & receiver)
+BasicRandList<E>::Weighted::randInt(const std::vector<weightType> & weights, container & receiver)
 {
-    typedef sp::details::Integer_t<valType> U;
     SPIRIT_ASSERT(weights.size() + 1 <= std::numeric_limits<valType>::max())
 
-    std::discrete_distribution<U> dist{weights.begin(), weights.end()};
-    auto it = receiver.begin();
+    WeightedSampler<valType, weightType> sampler{weights};
+    sampler.sample(Random::generator, receiver.begin(), receiver.end());
+}
 
-    while (it != receiver.end())
+
+// ///////////////////////////////////////////////////////
+template <typename valType, typename weightType>
+WeightedSampler<valType, weightType>::WeightedSampler(
+    std::initializer_list<weightType> weights
+)
+    : WeightedSampler{weights.begin(), weights.end()}
+{
+}
+
+
+// ///////////////////////////////////////////////////////
+template <typename valType, typename weightType>
+WeightedSampler<valType, weightType>::WeightedSampler(
+    const std::vector<weightType> & weights
+)
+    : WeightedSampler{weights.begin(), weights.end()}
+{
+}
+
+
+// ///////////////////////////////////////////////////////
+template <typename valType, typename weightType>
+template <typename IterType>
+WeightedSampler<valType, weightType>::WeightedSampler(IterType begin, IterType end)
+{
+    setWeights(begin, end);
+}
+
+
+// ///////////////////////////////////////////////////////
+template <typename valType, typename weightType>
+template <typename IterType>
+void
+WeightedSampler<valType, weightType>::setWeights(IterType begin, IterType end)
+{
+    weights.assign(begin, end);
+    SPIRIT_ASSERT(weights.size() <= std::numeric_limits<sp::Uint32>::max())
+    SPIRIT_ASSERT(weights.size() <= std::numeric_limits<valType>::max())
+
+    total = 0;
+    for (const weightType & w : weights)
     {
-        *it = dist(Random::generator);
-        ++it;
+        SPIRIT_ASSERT(w >= 0)
+        total += static_cast<double>(w);
+    }
+
+    dirty = true;
+}
+
+
+// ///////////////////////////////////////////////////////
+template <typename valType, typename weightType>
+void
+WeightedSampler<valType, weightType>::setWeight(std::size_t index, weightType weight)
+{
+    SPIRIT_ASSERT(index < weights.size())
+    SPIRIT_ASSERT(weight >= 0)
+
+    total += static_cast<double>(weight) - static_cast<double>(weights[index]);
+    weights[index] = weight;
+    dirty          = true;
+}
+
+
+// ///////////////////////////////////////////////////////
+template <typename valType, typename weightType>
+weightType
+WeightedSampler<valType, weightType>::weight(std::size_t index) const
+{
+    return weights[index];
+}
+
+
+// ///////////////////////////////////////////////////////
+template <typename valType, typename weightType>
+std::size_t
+WeightedSampler<valType, weightType>::size() const
+{
+    return weights.size();
+}
+
+
+// ///////////////////////////////////////////////////////
+template <typename valType, typename weightType>
+valType
+WeightedSampler<valType, weightType>::operator()()
+{
+    return (*this)(Random::engine());
+}
+
+
+// ///////////////////////////////////////////////////////
+template <typename valType, typename weightType>
+template <class Engine>
+valType
+WeightedSampler<valType, weightType>::operator()(Engine & engine)
+{
+    if (dirty)
+    {
+        rebuild();
     }
+
+    return select(static_cast<sp::Uint32>(engine()));
+}
+
+
+// ///////////////////////////////////////////////////////
+template <typename valType, typename weightType>
+template <class container>
+void
+WeightedSampler<valType, weightType>::sample(container & receiver)
+{
+    sample(receiver.begin(), receiver.end());
+}
+
+
+// ///////////////////////////////////////////////////////
+template <typename valType, typename weightType>
+template <typename IterType>
+void
+WeightedSampler<valType, weightType>::sample(IterType begin, IterType end)
+{
+    sample(Random::engine(), begin, end);
+}
+
+
+// ///////////////////////////////////////////////////////
+template <typename valType, typename weightType>
+template <class Engine, typename IterType>
+void
+WeightedSampler<valType, weightType>::sample(Engine & engine, IterType begin, IterType end)
+{
+    if (dirty)
+    {
+        rebuild();
+    }
+
+    if constexpr (sp::details::BulkFillable<valType, IterType>
+                  && !std::is_floating_point_v<valType>)
+    {
+        typedef sp::details::WordBatch WordBatch;
+        const WordBatch n{static_cast<sp::Uint32>(weights.size())};
+
+        sp::details::bulkFill(
+            engine,
+            std::to_address(begin),
+            end - begin,
+            [&](const sp::Uint32 * words) {
+                WordBatch low;
+                WordBatch index
+                    = sp::details::mulhilo(WordBatch::load_aligned(words), n, low);
+
+                WordBatch threshold = WordBatch::gather(thresholds.data(), index);
+                WordBatch alias     = WordBatch::gather(aliases.data(), index);
+
+                return xsimd::bitwise_cast<valType>(
+                    xsimd::select(low < threshold, index, alias)
+                );
+            }
+        );
+    }
+    else
+    {
+        for (auto it = begin; it != end; ++it)
+        {
+            *it = select(static_cast<sp::Uint32>(engine()));
+        }
+    }
+}
+
+
+// ///////////////////////////////////////////////////////
+template <typename valType, typename weightType>
+valType
+WeightedSampler<valType, weightType>::select(sp::Uint32 word) const
+{
+    // word / 2^32 * n, the integer part is the index and the fractional
+    // part is compared to the probability of keeping it.
+    // (the bias on the index is below n / 2^32)
+    sp::Uint64 scaledWord = sp::Uint64{word} * weights.size();
+    sp::Uint32 index      = static_cast<sp::Uint32>(scaledWord >> 32);
+    sp::Uint32 low        = static_cast<sp::Uint32>(scaledWord);
+
+    return static_cast<valType>(low < thresholds[index] ? index : aliases[index]);
+}
+
+
+// ///////////////////////////////////////////////////////
+template <typename valType, typename weightType>
+void
+WeightedSampler<valType, weightType>::rebuild()
+{
+    // Vose, "A Linear Algorithm For Generating Random Numbers
+    //  With a Given Distribution" (1991)
+
+    SPIRIT_ASSERT(total > 0)
+    const std::size_t n = weights.size();
+
+    thresholds.resize(n);
+    aliases.resize(n);
+    scaled.resize(n);
+    small.clear();
+    large.clear();
+
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        scaled[i] = static_cast<double>(weights[i]) * n / total;
+        (scaled[i] < 1 ? small : large).push_back(static_cast<sp::Uint32>(i));
+    }
+
+    auto toThreshold = [](double probability) {
+        return probability >= 1 ? std::numeric_limits<sp::Uint32>::max()
+                                : static_cast<sp::Uint32>(probability * 4294967296.0);
+    };
+
+    while (!small.empty() && !large.empty())
+    {
+        sp::Uint32 s = small.back();
+        sp::Uint32 l = large.back();
+        small.pop_back();
+
+        thresholds[s] = toThreshold(scaled[s]);
+        aliases[s]    = l;
+
+        scaled[l] = (scaled[l] + scaled[s]) - 1;
+        if (scaled[l] < 1)
+        {
+            large.pop_back();
+            small.push_back(l);
+        }
+    }
+
+    // only rounding errors remain, those are kept with certainty
+    for (std::vector<sp::Uint32> * remaining : {&small, &large})
+    {
+        for (sp::Uint32 i : *remaining)
+        {
+            thresholds[i] = std::numeric_limits<sp::Uint32>::max();
+            aliases[i]    = i;
+        }
+    }
+
+    dirty = false;
+}
+
+
+// ///////////////////////////////////////////////////////
+template <typename T>
+ReservoirSampler<T>::ReservoirSampler(std::size_t capacity) : maxItems{capacity}
+{
+    SPIRIT_ASSERT(capacity > 0)
+    items.reserve(capacity);
+}
+
+
+// ///////////////////////////////////////////////////////
+template <typename T>
+void
+ReservoirSampler<T>::add(const T & item)
+{
+    add(Random::engine(), item);
+}
+
+
+// ///////////////////////////////////////////////////////
+template <typename T>
+template <class Engine>
+void
+ReservoirSampler<T>::add(Engine & engine, const T & item)
+{
+    ++count;
+    if (items.size() < maxItems)
+    {
+        items.push_back(item);
+        if (items.size() == maxItems)
+        {
+            skip(engine);
+        }
+    }
+    else if (count == next)
+    {
+        items[sp::details::boundedInt(engine, maxItems)] = item;
+        skip(engine);
+    }
+}
+
+
+// ///////////////////////////////////////////////////////
+template <typename T>
+template <std::input_iterator IterType>
+void
+ReservoirSampler<T>::add(IterType begin, IterType end)
+{
+    add(Random::engine(), begin, end);
+}
+
+
+// ///////////////////////////////////////////////////////
+template <typename T>
+template <class Engine, std::input_iterator IterType>
+void
+ReservoirSampler<T>::add(Engine & engine, IterType begin, IterType end)
+{
+    if constexpr (std::random_access_iterator<IterType>)
+    {
+        for (; begin != end && items.size() < maxItems; ++begin)
+        {
+            add(engine, *begin);
+        }
+
+        // the items before the next replacement are only counted
+        while (begin != end)
+        {
+            sp::Uint64 remaining = static_cast<sp::Uint64>(end - begin);
+            sp::Uint64 skipped   = next - count - 1;
+            if (skipped >= remaining)
+            {
+                count += remaining;
+                return;
+            }
+
+            begin += skipped;
+            count += skipped;
+            add(engine, *begin);
+            ++begin;
+        }
+    }
+    else
+    {
+        for (; begin != end; ++begin)
+        {
+            add(engine, *begin);
+        }
+    }
+}
+
+
+// ///////////////////////////////////////////////////////
+template <typename T>
+const std::vector<T> &
+ReservoirSampler<T>::sample() const
+{
+    return items;
+}
+
+
+// ///////////////////////////////////////////////////////
+template <typename T>
+std::size_t
+ReservoirSampler<T>::capacity() const
+{
+    return maxItems;
+}
+
+
+// ///////////////////////////////////////////////////////
+template <typename T>
+sp::Uint64
+ReservoirSampler<T>::seen() const
+{
+    return count;
+}
+
+
+// ///////////////////////////////////////////////////////
+template <typename T>
+void
+ReservoirSampler<T>::clear()
+{
+    items.clear();
+    count = 0;
+    next  = 0;
+    w     = 1;
+}
+
+
+// ///////////////////////////////////////////////////////
+template <typename T>
+template <class Engine>
+void
+ReservoirSampler<T>::skip(Engine & engine)
+{
+    // uniform in (0, 1], so the logarithms stay finite
+    auto uniform = [&]() { return 1 - sp::details::unitDouble(engine); };
+
+    // the kept items are the ones with the smallest uniform keys,
+    // w is the largest of their keys
+    w *= std::exp(std::log(uniform()) / static_cast<double>(maxItems));
+
+    // geometric number of items with a larger key, capped to stay representable
+    double gap = std::floor(std::log(uniform()) / std::log1p(-w));
+    next = count + 1 + (gap < 0x1.0p62 ? static_cast<sp::Uint64>(gap) : sp::Uint64{1} << 62);
 }
 
 } // namespace sp
@@ -0,0 +1,669 @@
+////////////////////////////////////////////////////////////
+//
+// Spirit
+// Copyright (C) 2022 Matthieu Beauchamp-Boulay
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it freely,
+// subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+////////////////////////////////////////////////////////////
+
+
+
+#ifndef SPIRIT_SEQUENCE_HPP
+#define SPIRIT_SEQUENCE_HPP
+
+#include "SPIRIT/Base.hpp"
+#include "SPIRIT/Math/Matrix/Matrix.hpp"
+#include "SPIRIT/Math/Parallel/Parallel.hpp"
+#include "SPIRIT/Math/Random/SplitMix.hpp"
+
+#include <array>
+#include <bit>
+#include <cmath>
+#include <iterator>
+#include <limits>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+////////////////////////////////////////////////////////////
+// Low-discrepancy (quasi-random) sequences.
+//
+// Points of these sequences cover [0, 1)^dim much more evenly than
+// uniform random numbers, Monte-Carlo estimates built from them
+// converge close to 1/n instead of 1/sqrt(n).
+//
+// Every point can be computed directly from its index, so a sequence
+// can be split across threads (fill with sp::Execution::Parallel) or
+// tasks (seek to the first index of each task).
+//
+// Scrambling randomizes a sequence while keeping its distribution
+// properties, giving independent estimates (for error estimation)
+// and removing the structure of the unscrambled points.
+////////////////////////////////////////////////////////////
+
+namespace sp
+{
+
+enum class Scrambling
+{
+    None,
+    RandomDigit, // digits permuted (or shifted) the same way for every point
+    Owen         // each digit permuted depending on the previous ones
+};
+
+
+namespace details
+{
+
+// [0, 1) fixed point fraction to T, never rounds up to 1
+template <class T>
+T
+fromFraction(sp::Uint64 fraction)
+{
+    if constexpr (std::is_same_v<T, float>)
+    {
+        return static_cast<float>(fraction >> 40) * 0x1.0p-24f;
+    }
+    else
+    {
+        return static_cast<T>(static_cast<double>(fraction >> 11) * 0x1.0p-53);
+    }
+}
+
+
+////////////////////////////////////////////////////////////
+/// \brief Interface shared by the low-discrepancy sequences
+///
+/// Derived provides:
+/// - State stateAt(sp::Uint64 index) const
+/// - void step(State & state, sp::Uint64 index) const,
+///     moves state from index - 1 to index
+/// - sp::Uint64 output(const State & state, sp::Uint64 index, sp::Int32 d) const,
+///     coordinate d as a [0, 1) fixed point fraction
+////////////////////////////////////////////////////////////
+template <class Derived, sp::Int32 dim>
+class Sequence
+{
+public:
+
+    constexpr static sp::Int32 dimension = dim;
+
+    // Point at index of the sequence
+    template <class T = float>
+    sp::Vector<T, dim>
+    point(sp::Uint64 index) const
+    {
+        return pointOf<T>(derived().stateAt(index), index);
+    }
+
+    // Next point of the sequence
+    template <class T = float>
+    sp::Vector<T, dim>
+    operator()()
+    {
+        return point<T>(next++);
+    }
+
+    // Moves to index, the next point will be point(index)
+    void
+    seek(sp::Uint64 index)
+    {
+        next = index;
+    }
+
+    // Index of the next point
+    sp::Uint64
+    index() const
+    {
+        return next;
+    }
+
+    // Fills points with the next points.size() points
+    template <class T>
+    void
+    fill(
+        std::span<sp::Vector<T, dim>> points,
+        sp::Execution execution = sp::Execution::Sequential
+    )
+    {
+        fillImpl(points.size(), execution, [&](std::size_t i, const auto & state) {
+            points[i] = pointOf<T>(state, next + i);
+        });
+        next += points.size();
+    }
+
+    // Fills values with the coordinates of the next values.size() / dim points,
+    // interleaved (x0, y0, x1, y1, ... for dim = 2)
+    template <class T>
+        requires std::is_floating_point_v<T>
+    void
+    fill(std::span<T> values, sp::Execution execution = sp::Execution::Sequential)
+    {
+        SPIRIT_ASSERT(values.size() % dim == 0)
+
+        std::size_t nPoints = values.size() / dim;
+        fillImpl(nPoints, execution, [&](std::size_t i, const auto & state) {
+            for (sp::Int32 d = 0; d < dim; ++d)
+            {
+                values[i * dim + d] = fromFraction<T>(derived().output(state, next + i, d));
+            }
+        });
+        next += nPoints;
+    }
+
+    // Fills [begin, end) with the next points, the range holds either
+    // sp::Vector<T, dim> or interleaved coordinates of T (see above)
+    template <typename IterType>
+    void
+    fill(IterType begin, IterType end)
+    {
+        typedef std::iter_value_t<IterType> Value;
+
+        if constexpr (std::contiguous_iterator<IterType>)
+        {
+            fill(std::span<Value>{std::to_address(begin), std::to_address(end)});
+        }
+        else if constexpr (std::is_floating_point_v<Value>)
+        {
+            for (auto it = begin; it != end; ++next)
+            {
+                auto state = derived().stateAt(next);
+                for (sp::Int32 d = 0; d < dim && it != end; ++d, ++it)
+                {
+                    *it = fromFraction<Value>(derived().output(state, next, d));
+                }
+            }
+        }
+        else
+        {
+            typedef std::remove_cvref_t<decltype(std::declval<Value>()[0])> T;
+            for (auto it = begin; it != end; ++it)
+            {
+                *it = (*this).template operator()<T>();
+            }
+        }
+    }
+
+private:
+
+    const Derived &
+    derived() const
+    {
+        return static_cast<const Derived &>(*this);
+    }
+
+    template <class T, class State>
+    sp::Vector<T, dim>
+    pointOf(const State & state, sp::Uint64 index) const
+    {
+        sp::Vector<T, dim> res;
+        for (sp::Int32 d = 0; d < dim; ++d)
+        {
+            res[d] = fromFraction<T>(derived().output(state, index, d));
+        }
+        return res;
+    }
+
+    // Calls emit(i, state of next + i) for i in [0, n), each thread
+    // computes its first state directly and steps from there.
+    template <class Emit>
+    void
+    fillImpl(std::size_t n, sp::Execution execution, Emit && emit) const
+    {
+        auto kernel = [&](std::size_t begin, std::size_t end) {
+            if (begin == end)
+            {
+                return;
+            }
+
+            auto state = derived().stateAt(next + begin);
+            emit(begin, state);
+            for (std::size_t i = begin + 1; i < end; ++i)
+            {
+                derived().step(state, next + i);
+                emit(i, state);
+            }
+        };
+
+        sp::details::parallelFor(n, execution, kernel);
+    }
+
+    sp::Uint64 next = 0;
+};
+
+// Independent seeds for each dimension
+template <sp::Int32 dim>
+std::array<sp::Uint64, dim>
+dimensionSeeds(sp::Uint64 seed)
+{
+    sp::SplitMix64 expand{seed};
+    std::array<sp::Uint64, dim> seeds;
+    for (sp::Uint64 & s : seeds)
+    {
+        s = expand();
+    }
+    return seeds;
+}
+
+} // namespace details
+
+
+////////////////////////////////////////////////////////////
+/// \brief Sobol sequence, in Gray code order
+///
+/// Sobol, "On the distribution of points in a cube and the approximate
+/// evaluation of integrals" (1967), with the direction numbers of
+/// Joe and Kuo, "Constructing Sobol sequences with better two-dimensional
+/// projections" (2008). Points are in Gray code order (Antonov and Saleev),
+/// each one is a single xor away from the previous one.
+///
+/// The first 2^m points of any two dimensions stratify [0, 1)^2 into
+/// every grid of 2^m cells of size 2^-a by 2^-(m - a), start with a power
+/// of 2 number of samples to make the most of it.
+///
+/// Owen scrambling uses Burley's hash based permutation ("Practical
+/// Hash-based Owen Scrambling", 2020). Both scramblings keep the
+/// stratification above.
+///
+/// <code>
+/// sp::SobolSequence<2> sobol{sp::Scrambling::Owen, seed};
+/// std::vector<sp::Vec2> samples(256);
+/// sobol.fill(std::span{samples});
+/// </code>
+///
+/// \tparam dim Number of dimensions, up to maxDimension
+////////////////////////////////////////////////////////////
+template <sp::Int32 dim>
+class SobolSequence : public details::Sequence<SobolSequence<dim>, dim>
+{
+public:
+
+    constexpr static sp::Int32 maxDimension = 8;
+    static_assert(dim >= 1 && dim <= maxDimension);
+
+    typedef std::array<sp::Uint32, dim> State;
+
+    explicit SobolSequence(Scrambling scrambling = Scrambling::None, sp::Uint64 seed = 0)
+        : scrambling{scrambling}, seeds{details::dimensionSeeds<dim>(seed)}
+    {
+        // (degree, coefficients, initial direction numbers) of dimensions 2 and above
+        constexpr struct
+        {
+            sp::Int32 s;
+            sp::Uint32 a;
+            std::array<sp::Uint32, 5> m;
+        } joeKuo[maxDimension - 1]{
+            {1, 0, {1}},
+            {2, 1, {1, 3}},
+            {3, 1, {1, 3, 1}},
+            {3, 2, {1, 1, 1}},
+            {4, 1, {1, 1, 3, 3}},
+            {4, 4, {1, 3, 5, 13}},
+            {5, 2, {1, 1, 5, 5, 17}}};
+
+        for (sp::Int32 k = 0; k < 32; ++k)
+        {
+            directions[0][k] = sp::Uint32{1} << (31 - k);
+        }
+
+        for (sp::Int32 d = 1; d < dim; ++d)
+        {
+            const auto & [s, a, m] = joeKuo[d - 1];
+            std::array<sp::Uint32, 32> & v = directions[d];
+
+            for (sp::Int32 k = 0; k < s; ++k)
+            {
+                v[k] = m[k] << (31 - k);
+            }
+
+            for (sp::Int32 k = s; k < 32; ++k)
+            {
+                v[k] = v[k - s] ^ (v[k - s] >> s);
+                for (sp::Int32 i = 1; i < s; ++i)
+                {
+                    if ((a >> (s - 1 - i)) & 1)
+                    {
+                        v[k] ^= v[k - i];
+                    }
+                }
+            }
+        }
+    }
+
+    State
+    stateAt(sp::Uint64 index) const
+    {
+        SPIRIT_ASSERT(index <= std::numeric_limits<sp::Uint32>::max())
+
+        sp::Uint32 gray = static_cast<sp::Uint32>(index ^ (index >> 1));
+        State state{};
+        for (sp::Int32 k = 0; gray != 0; ++k, gray >>= 1)
+        {
+            if (gray & 1)
+            {
+                for (sp::Int32 d = 0; d < dim; ++d)
+                {
+                    state[d] ^= directions[d][k];
+                }
+            }
+        }
+        return state;
+    }
+
+    void
+    step(State & state, sp::Uint64 index) const
+    {
+        // the 32 direction numbers cover the first 2^32 points
+        SPIRIT_ASSERT(index <= std::numeric_limits<sp::Uint32>::max())
+
+        sp::Int32 k = std::countr_zero(index);
+        for (sp::Int32 d = 0; d < dim; ++d)
+        {
+            state[d] ^= directions[d][k];
+        }
+    }
+
+    sp::Uint64
+    output(const State & state, sp::Uint64, sp::Int32 d) const
+    {
+        sp::Uint32 x = state[d];
+        switch (scrambling)
+        {
+            case Scrambling::None: break;
+            case Scrambling::RandomDigit: x ^= static_cast<sp::Uint32>(seeds[d]); break;
+            case Scrambling::Owen: x = owen(x, static_cast<sp::Uint32>(seeds[d])); break;
+        }
+        return sp::Uint64{x} << 32;
+    }
+
+private:
+
+    static sp::Uint32
+    reverseBits(sp::Uint32 x)
+    {
+        x = ((x >> 1) & 0x55555555) | ((x & 0x55555555) << 1);
+        x = ((x >> 2) & 0x33333333) | ((x & 0x33333333) << 2);
+        x = ((x >> 4) & 0x0F0F0F0F) | ((x & 0x0F0F0F0F) << 4);
+        x = ((x >> 8) & 0x00FF00FF) | ((x & 0x00FF00FF) << 8);
+        return (x >> 16) | (x << 16);
+    }
+
+    // in the reversed word, each bit only depends on the ones below it
+    static sp::Uint32
+    owen(sp::Uint32 x, sp::Uint32 seed)
+    {
+        x = reverseBits(x);
+        x += seed;
+        x ^= x * 0x6C50B47C;
+        x ^= x * 0xB82F1E52;
+        x ^= x * 0xC7AFE638;
+        x ^= x * 0x8D22F6E6;
+        return reverseBits(x);
+    }
+
+    Scrambling scrambling;
+    std::array<sp::Uint64, dim> seeds;
+    std::array<std::array<sp::Uint32, 32>, dim> directions;
+};
+
+
+////////////////////////////////////////////////////////////
+/// \brief Halton sequence
+///
+/// Halton, "On the efficiency of certain quasi-random sequences of points
+/// in evaluating multi-dimensional integrals" (1960).
+///
+/// Dimension d is the radical inverse of the index in the d-th prime base.
+/// Any number of dimensions is supported but high dimensions (large bases)
+/// are correlated unless scrambled.
+///
+/// RandomDigit scrambling applies a random permutation of the digits
+/// per dimension and digit position (Kocis and Whiten, 1997). Owen
+/// scrambling shifts each digit by a hash of the digits before it.
+/// Both also scramble the infinite trailing zeros, down to the precision
+/// of a double.
+///
+/// \tparam dim Number of dimensions
+////////////////////////////////////////////////////////////
+template <sp::Int32 dim>
+class HaltonSequence : public details::Sequence<HaltonSequence<dim>, dim>
+{
+public:
+
+    typedef sp::Uint64 State;
+
+    explicit HaltonSequence(Scrambling scrambling = Scrambling::None, sp::Uint64 seed = 0)
+        : scrambling{scrambling}, seeds{details::dimensionSeeds<dim>(seed)}
+    {
+        sp::Uint32 candidate = 2;
+        for (sp::Int32 d = 0; d < dim; ++candidate)
+        {
+            bool isPrime = true;
+            for (sp::Int32 i = 0; i < d && bases[i] * bases[i] <= candidate; ++i)
+            {
+                isPrime = isPrime && candidate % bases[i] != 0;
+            }
+
+            if (isPrime)
+            {
+                bases[d++] = candidate;
+            }
+        }
+
+        if (scrambling == Scrambling::RandomDigit)
+        {
+            permutations.resize(dim);
+            for (sp::Int32 d = 0; d < dim; ++d)
+            {
+                const sp::Uint32 base = bases[d];
+                sp::SplitMix64 engine{seeds[d]};
+                std::vector<sp::Uint32> & permutation = permutations[d];
+
+                // Fisher-Yates, one permutation per digit position output reaches
+                const sp::Int32 nDigits = digitCount(base);
+                permutation.resize(static_cast<std::size_t>(nDigits) * base);
+                for (sp::Int32 k = 0; k < nDigits; ++k)
+                {
+                    sp::Uint32 * digits = permutation.data() + k * base;
+                    for (sp::Uint32 i = 0; i < base; ++i)
+                    {
+                        digits[i] = i;
+                    }
+                    for (sp::Uint32 i = base - 1; i > 0; --i)
+                    {
+                        std::swap(digits[i], digits[engine() % (i + 1)]);
+                    }
+                }
+            }
+        }
+    }
+
+    State
+    stateAt(sp::Uint64 index) const
+    {
+        return index;
+    }
+
+    void
+    step(State & state, sp::Uint64 index) const
+    {
+        state = index;
+    }
+
+    sp::Uint64
+    output(const State & state, sp::Uint64, sp::Int32 d) const
+    {
+        const sp::Uint32 base = bases[d];
+        const double invBase  = 1.0 / base;
+
+        double x      = 0;
+        double factor = invBase;
+        sp::Uint64 n  = state;
+        sp::Uint64 prefix = seeds[d];
+
+        // scrambling must go on past the digits of n, until they vanish
+        const bool scrambled = scrambling != Scrambling::None;
+        for (sp::Uint32 k = 0; n != 0 || (scrambled && isVisible(factor)); ++k)
+        {
+            sp::Uint32 digit = static_cast<sp::Uint32>(n % base);
+            n /= base;
+
+            if (scrambling == Scrambling::RandomDigit)
+            {
+                digit = permutations[d][k * base + digit];
+            }
+            else if (scrambling == Scrambling::Owen)
+            {
+                sp::Uint64 hash = sp::SplitMix64::mix(prefix);
+                prefix          = hash ^ digit;
+                digit           = static_cast<sp::Uint32>((digit + hash % base) % base);
+            }
+
+            x += digit * factor;
+            factor *= invBase;
+        }
+
+        return static_cast<sp::Uint64>(std::min(x, 0x1.fffffffffffffp-1) * 0x1.0p64);
+    }
+
+    sp::Uint32
+    base(sp::Int32 d) const
+    {
+        return bases[d];
+    }
+
+private:
+
+    // whether a digit of weight factor still changes the output
+    static bool
+    isVisible(double factor)
+    {
+        return factor > 0x1.0p-54;
+    }
+
+    // number of digits output goes through for any index, in base
+    static sp::Int32
+    digitCount(sp::Uint32 base)
+    {
+        const double invBase = 1.0 / base;
+
+        sp::Int32 count = 0;
+        double factor   = invBase;
+        sp::Uint64 n    = std::numeric_limits<sp::Uint64>::max();
+        for (; n != 0 || isVisible(factor); ++count)
+        {
+            n /= base;
+            factor *= invBase;
+        }
+        return count;
+    }
+
+    Scrambling scrambling;
+    std::array<sp::Uint64, dim> seeds;
+    std::array<sp::Uint32, dim> bases{};
+
+    // digitCount(base) permutations of the digits per dimension
+    std::vector<std::vector<sp::Uint32>> permutations{};
+};
+
+
+////////////////////////////////////////////////////////////
+/// \brief R2 (generalized golden ratio) sequence
+///
+/// Roberts, "The Unreasonable Effectiveness of Quasirandom Sequences" (2018).
+///
+/// An additive recurrence, point n is frac(0.5 + n * alpha) with
+/// alpha_d = phi^-(d + 1), where phi is the real root of x^(dim + 1) = x + 1.
+/// The cheapest sequence and evenly spread for any number of points,
+/// while Sobol's stratification requires powers of 2.
+///
+/// Computed in 64 bits fixed point, exact for any index.
+/// Both scramblings apply a random toroidal shift (Cranley-Patterson
+/// rotation), the sequence has no digits to permute.
+///
+/// \tparam dim Number of dimensions
+////////////////////////////////////////////////////////////
+template <sp::Int32 dim>
+class R2Sequence : public details::Sequence<R2Sequence<dim>, dim>
+{
+public:
+
+    typedef std::array<sp::Uint64, dim> State;
+
+    explicit R2Sequence(Scrambling scrambling = Scrambling::None, sp::Uint64 seed = 0)
+    {
+        // Newton's method on x^(dim + 1) - x - 1
+        double phi = 2;
+        for (sp::Int32 i = 0; i < 64; ++i)
+        {
+            phi -= (std::pow(phi, dim + 1) - phi - 1) / ((dim + 1) * std::pow(phi, dim) - 1);
+        }
+
+        std::array<sp::Uint64, dim> seeds = details::dimensionSeeds<dim>(seed);
+        double inverse = 1;
+        for (sp::Int32 d = 0; d < dim; ++d)
+        {
+            inverse /= phi;
+            alphas[d] = static_cast<sp::Uint64>(inverse * 0x1.0p64);
+            starts[d] = sp::Uint64{1} << 63;
+            if (scrambling != Scrambling::None)
+            {
+                starts[d] += seeds[d];
+            }
+        }
+    }
+
+    State
+    stateAt(sp::Uint64 index) const
+    {
+        State state;
+        for (sp::Int32 d = 0; d < dim; ++d)
+        {
+            state[d] = starts[d] + index * alphas[d];
+        }
+        return state;
+    }
+
+    void
+    step(State & state, sp::Uint64) const
+    {
+        for (sp::Int32 d = 0; d < dim; ++d)
+        {
+            state[d] += alphas[d];
+        }
+    }
+
+    sp::Uint64
+    output(const State & state, sp::Uint64, sp::Int32 d) const
+    {
+        return state[d];
+    }
+
+private:
+
+    std::array<sp::Uint64, dim> alphas;
+    std::array<sp::Uint64, dim> starts;
+};
+
+} // namespace sp
+
+
+#endif // SPIRIT_SEQUENCE_HPP
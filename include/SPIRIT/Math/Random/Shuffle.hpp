@@ -0,0 +1,339 @@
+////////////////////////////////////////////////////////////
+//
+// Spirit
+// Copyright (C) 2022 Matthieu Beauchamp-Boulay
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it freely,
+// subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+////////////////////////////////////////////////////////////
+
+
+
+#ifndef SPIRIT_RANDOM_SHUFFLE_HPP
+#define SPIRIT_RANDOM_SHUFFLE_HPP
+
+#include "SPIRIT/Base.hpp"
+#include "SPIRIT/Math/Parallel/Parallel.hpp"
+#include "SPIRIT/Math/Random/Bulk.hpp"
+#include "SPIRIT/Math/Random/SplitMix.hpp"
+
+#include <algorithm>
+#include <array>
+#include <iterator>
+#include <type_traits>
+
+
+////////////////////////////////////////////////////////////
+// Random permutations for RandList.
+//
+// Fisher-Yates swaps each element with a random earlier one, which is
+// a cache miss per element once the range no longer fits in cache.
+// Large ranges are shuffled with MergeShuffle instead: blocks that fit
+// in cache are shuffled on their own, then merged pairwise with random
+// bits, reading and writing memory mostly sequentially.
+//
+// Bacher, Bodini, Hollender and Lumbroso,
+// "MergeShuffle: A Very Fast, Parallel Random Permutation Algorithm" (2015)
+////////////////////////////////////////////////////////////
+
+namespace sp
+{
+
+namespace details
+{
+
+// Elements shuffled with Fisher-Yates before merging
+constexpr std::size_t shuffleBlockSize = 1 << 15;
+
+
+// Random bits drawn 64 at a time
+template <class Engine>
+class RandomBits
+{
+public:
+
+    explicit RandomBits(Engine & engine) : engine{engine} {}
+
+    bool
+    operator()()
+    {
+        if (nBits == 0)
+        {
+            bits  = engine();
+            nBits = 64;
+        }
+
+        bool bit = bits & 1;
+        bits >>= 1;
+        --nBits;
+        return bit;
+    }
+
+private:
+
+    Engine & engine;
+    sp::Uint64 bits = 0;
+    sp::Int32 nBits = 0;
+};
+
+
+////////////////////////////////////////////////////////////
+/// \brief two independent uniform integers in [0, range) and [0, range + 1)
+///
+/// Both come from a single 64 bits output, the rejection is done once
+/// for the product of the ranges, range * (range + 1) must fit in 64 bits.
+///
+/// Brackett-Rozinsky and Lemire,
+/// "Batched Ranged Random Integer Generation" (2024)
+////////////////////////////////////////////////////////////
+template <class Engine>
+std::array<sp::Uint64, 2>
+boundedPair(Engine & engine, sp::Uint64 range)
+{
+    const sp::Uint64 product = range * (range + 1);
+
+    auto draw = [&](std::array<sp::Uint64, 2> & res) {
+        sp::Uint64 word = engine();
+        res[0]          = sp::details::mulhi64(word, range);
+        word *= range;
+        res[1] = sp::details::mulhi64(word, range + 1);
+        return word * (range + 1);
+    };
+
+    std::array<sp::Uint64, 2> res;
+    sp::Uint64 low = draw(res);
+    if (low < product)
+    {
+        const sp::Uint64 threshold = (0 - product) % product;
+        while (low < threshold)
+        {
+            low = draw(res);
+        }
+    }
+
+    return res;
+}
+
+// Ranges whose successive Fisher-Yates draws can be paired by boundedPair
+constexpr std::size_t maxPairedRange = std::size_t{1} << 31;
+
+
+// Fisher-Yates (Durstenfeld) shuffle, walking forward
+template <class Engine, class RandomIt>
+void
+fisherYates(Engine & engine, RandomIt first, RandomIt last)
+{
+    std::size_t n = static_cast<std::size_t>(last - first);
+    std::size_t i = 1;
+    for (; i + 1 < std::min(n, maxPairedRange); i += 2)
+    {
+        auto [j, k] = boundedPair(engine, i + 1);
+        std::iter_swap(first + i, first + static_cast<std::size_t>(j));
+        std::iter_swap(first + i + 1, first + static_cast<std::size_t>(k));
+    }
+
+    for (; i < n; ++i)
+    {
+        std::size_t j = static_cast<std::size_t>(boundedInt(engine, i + 1));
+        std::iter_swap(first + i, first + j);
+    }
+}
+
+// Random permutation of offset, offset + 1, ... built in place ("inside-out")
+template <class Engine, class RandomIt>
+void
+insideOut(Engine & engine, RandomIt first, RandomIt last, std::size_t offset)
+{
+    typedef std::iter_value_t<RandomIt> Value;
+
+    auto insert = [&](std::size_t i, std::size_t j) {
+        first[i] = first[j];
+        first[j] = static_cast<Value>(offset + i);
+    };
+
+    std::size_t n = static_cast<std::size_t>(last - first);
+    std::size_t i = 0;
+    for (; i + 1 < std::min(n, maxPairedRange); i += 2)
+    {
+        auto [j, k] = boundedPair(engine, i + 1);
+        insert(i, static_cast<std::size_t>(j));
+        insert(i + 1, static_cast<std::size_t>(k));
+    }
+
+    for (; i < n; ++i)
+    {
+        insert(i, static_cast<std::size_t>(boundedInt(engine, i + 1)));
+    }
+}
+
+////////////////////////////////////////////////////////////
+/// \brief merges the shuffled [first, middle) and [middle, last)
+///
+/// A random bit picks the next element from either half until one
+/// runs out. The rest of the other half is then inserted at random
+/// positions, as in Fisher-Yates. The result is a uniform permutation
+/// of [first, last) for any sizes of the halves.
+////////////////////////////////////////////////////////////
+template <class Engine, class RandomIt>
+void
+mergeShuffled(Engine & engine, RandomIt first, RandomIt middle, RandomIt last)
+{
+    typedef std::iter_value_t<RandomIt> Value;
+    RandomBits<Engine> flip{engine};
+
+    RandomIt u = first;
+    RandomIt v = middle;
+
+    // Neither half is exhausted: the loop below cannot stop, so the swaps
+    // are done without a mispredicted branch per element.
+    if constexpr (std::is_trivially_copyable_v<Value>)
+    {
+        while (u != v && v != last)
+        {
+            // indexing keeps compilers from turning the selects into branches
+            std::size_t bit = flip();
+            Value pair[2]   = {*u, *v};
+            *u              = pair[bit];
+            *v              = pair[1 - bit];
+            v += bit;
+            ++u;
+        }
+    }
+
+    while (true)
+    {
+        if (flip())
+        {
+            if (v == last)
+            {
+                break;
+            }
+            std::iter_swap(u, v);
+            ++v;
+        }
+        else if (u == v)
+        {
+            break;
+        }
+        ++u;
+    }
+
+    for (; u != last; ++u)
+    {
+        std::size_t i = static_cast<std::size_t>(u - first);
+        std::iter_swap(u, first + static_cast<std::size_t>(boundedInt(engine, i + 1)));
+    }
+}
+
+////////////////////////////////////////////////////////////
+/// \brief MergeShuffle of [first, last)
+///
+/// shuffleBlock(engine, blockFirst, blockLast) shuffles one block,
+/// the blocks are then merged by pairs, level by level.
+///
+/// Blocks and merges draw from their own engines, the i-th one seeded
+/// with the i-th output of a SplitMix64 seeded from engine (streams of
+/// engines such as xoshiro are not constant time), so the result is the
+/// same for both executions. The outputs are computed directly from i and
+/// are all distinct.
+/// Ranges of a single block are shuffled with engine directly.
+////////////////////////////////////////////////////////////
+template <class Engine, class RandomIt, class ShuffleBlock>
+void
+mergeShuffle(
+    Engine & engine,
+    RandomIt first,
+    RandomIt last,
+    sp::Execution execution,
+    ShuffleBlock && shuffleBlock,
+    std::size_t blockSize = shuffleBlockSize
+)
+{
+    std::size_t n = static_cast<std::size_t>(last - first);
+    if (n <= blockSize)
+    {
+        shuffleBlock(engine, first, last);
+        return;
+    }
+
+    const sp::Uint64 seed     = engine();
+    const std::size_t nBlocks = (n + blockSize - 1) / blockSize;
+
+    auto seedOf = [&](sp::Uint64 index) {
+        return sp::SplitMix64::mix(seed + (index + 1) * sp::SplitMix64::gamma);
+    };
+
+    // blocks of nearly equal sizes
+    auto bound = [&](std::size_t block) {
+        return first + static_cast<std::size_t>(sp::Uint64{block} * n / nBlocks);
+    };
+
+    sp::details::parallelFor(
+        nBlocks,
+        execution,
+        [&](std::size_t begin, std::size_t end) {
+            for (std::size_t b = begin; b < end; ++b)
+            {
+                Engine blockEngine{seedOf(b)};
+                shuffleBlock(blockEngine, bound(b), bound(b + 1));
+            }
+        },
+        1,
+        1
+    );
+
+    sp::Uint64 index = nBlocks;
+    for (std::size_t width = 1; width < nBlocks; width *= 2)
+    {
+        const std::size_t nMerges = (nBlocks + 2 * width - 1) / (2 * width);
+        sp::details::parallelFor(
+            nMerges,
+            execution,
+            [&](std::size_t begin, std::size_t end) {
+                for (std::size_t m = begin; m < end; ++m)
+                {
+                    std::size_t left   = 2 * m * width;
+                    std::size_t middle = left + width;
+                    if (middle >= nBlocks)
+                    {
+                        continue;
+                    }
+
+                    Engine mergeEngine{seedOf(index + m)};
+                    mergeShuffled(
+                        mergeEngine,
+                        bound(left),
+                        bound(middle),
+                        bound(std::min(middle + width, nBlocks))
+                    );
+                }
+            },
+            1,
+            1
+        );
+
+        index += nMerges;
+    }
+}
+
+} // namespace details
+
+} // namespace sp
+
+
+#endif // SPIRIT_RANDOM_SHUFFLE_HPP
@@ -0,0 +1,136 @@
+////////////////////////////////////////////////////////////
+//
+// Spirit
+// Copyright (C) 2022 Matthieu Beauchamp-Boulay
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it freely,
+// subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+////////////////////////////////////////////////////////////
+
+
+
+#ifndef SPIRIT_SPLITMIX_HPP
+#define SPIRIT_SPLITMIX_HPP
+
+#include "SPIRIT/Base.hpp"
+
+#include <limits>
+
+
+namespace sp
+{
+
+//////////////////////////////////////////////////////////
+///
+/// \brief SplitMix64 random engine
+///
+/// From Steele et al., "Fast Splittable Pseudorandom Number Generators" (2014).
+///
+/// A Weyl sequence (the state advances by a constant) hashed by a mixing
+/// function. The state is a single 64 bits word and any position can be
+/// reached in constant time, but the period is only 2^64. Mostly useful to
+/// expand a seed into the state of larger engines (see sp::Xoshiro256).
+///
+/// The seed(seed, stream) streams are 2^48 outputs apart (2^16 streams),
+/// jump() advances by 2^32 outputs and longJump() by 2^48.
+///
+/// Satisfies the UniformRandomBitGenerator requirements with 64 bits outputs.
+///
+//////////////////////////////////////////////////////////
+class SplitMix64
+{
+public:
+
+    typedef sp::Uint64 result_type;
+
+    constexpr static sp::Uint64 gamma = 0x9E3779B97F4A7C15;
+
+    constexpr static result_type defaultSeed = 0x5EED;
+
+    explicit SplitMix64(result_type seed = defaultSeed, result_type stream = 0)
+    {
+        this->seed(seed, stream);
+    }
+
+    void
+    seed(result_type seed, result_type stream = 0)
+    {
+        state = seed + (stream << 48) * gamma;
+    }
+
+    result_type
+    operator()()
+    {
+        state += gamma;
+        return mix(state);
+    }
+
+    // Advances the engine by n outputs in constant time
+    void
+    discard(unsigned long long n)
+    {
+        state += n * gamma;
+    }
+
+    // Advances the engine by 2^32 outputs
+    void
+    jump()
+    {
+        discard(sp::Uint64{1} << 32);
+    }
+
+    // Advances the engine by 2^48 outputs, to the next stream
+    void
+    longJump()
+    {
+        discard(sp::Uint64{1} << 48);
+    }
+
+    // The output function, a bijection of 64 bits words
+    constexpr static sp::Uint64
+    mix(sp::Uint64 z)
+    {
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+        return z ^ (z >> 31);
+    }
+
+    constexpr static result_type
+    min()
+    {
+        return 0;
+    }
+
+    constexpr static result_type
+    max()
+    {
+        return std::numeric_limits<result_type>::max();
+    }
+
+    bool
+    operator==(const SplitMix64 & other) const = default;
+
+private:
+
+    sp::Uint64 state;
+};
+
+} // namespace sp
+
+
+#endif // SPIRIT_SPLITMIX_HPP
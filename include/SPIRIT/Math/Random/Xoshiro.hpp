@@ -0,0 +1,203 @@
+////////////////////////////////////////////////////////////
+//
+// Spirit
+// Copyright (C) 2022 Matthieu Beauchamp-Boulay
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it freely,
+// subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+////////////////////////////////////////////////////////////
+
+
+
+#ifndef SPIRIT_XOSHIRO_HPP
+#define SPIRIT_XOSHIRO_HPP
+
+#include "SPIRIT/Base.hpp"
+#include "SPIRIT/Math/Random/SplitMix.hpp"
+
+#include <array>
+#include <limits>
+
+
+namespace sp
+{
+
+//////////////////////////////////////////////////////////
+///
+/// \brief xoshiro256** random engine
+///
+/// From Blackman and Vigna, "Scrambled Linear Pseudorandom Number
+/// Generators" (2021).
+///
+/// 32 bytes of state, a period of 2^256 - 1 and a handful of shifts,
+/// rotations and multiplications per output, the fastest engine
+/// for scalar draws.
+///
+/// The state is expanded from the seed with sp::SplitMix64.
+/// jump() advances by 2^128 outputs and longJump() by 2^192, giving
+/// non-overlapping substreams. seed(seed, stream) jumps stream times,
+/// its cost is linear in stream: to create many generators, copy
+/// one and jump() each copy from the previous one instead.
+///
+/// <code>
+/// std::vector<sp::Xoshiro256> generators;
+/// sp::Xoshiro256 engine{seed};
+/// for (Entity & entity : entities)
+/// {
+///     generators.push_back(engine);
+///     engine.jump();
+/// }
+/// </code>
+///
+/// Satisfies the UniformRandomBitGenerator requirements with 64 bits outputs.
+///
+//////////////////////////////////////////////////////////
+class Xoshiro256
+{
+public:
+
+    typedef sp::Uint64 result_type;
+
+    typedef std::array<sp::Uint64, 4> State;
+
+    constexpr static result_type defaultSeed = 0x5EED;
+
+    explicit Xoshiro256(result_type seed = defaultSeed, result_type stream = 0)
+    {
+        this->seed(seed, stream);
+    }
+
+    // s must not be all zeros
+    explicit Xoshiro256(const State & s) : s{s} {}
+
+    void
+    seed(result_type seed, result_type stream = 0)
+    {
+        sp::SplitMix64 expand{seed};
+        for (sp::Uint64 & word : s)
+        {
+            word = expand();
+        }
+
+        for (result_type i = 0; i < stream; ++i)
+        {
+            jump();
+        }
+    }
+
+    result_type
+    operator()()
+    {
+        result_type res = rotl(s[1] * 5, 7) * 9;
+        sp::Uint64 t    = s[1] << 17;
+
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotl(s[3], 45);
+
+        return res;
+    }
+
+    void
+    discard(unsigned long long n)
+    {
+        for (; n != 0; --n)
+        {
+            (*this)();
+        }
+    }
+
+    // Advances the engine by 2^128 outputs
+    void
+    jump()
+    {
+        jump({0x180EC6D33CFD0ABA, 0xD5A61266F0C9392C, 0xA9582618E03FC9AA, 0x39ABDC4529B1661C});
+    }
+
+    // Advances the engine by 2^192 outputs
+    void
+    longJump()
+    {
+        jump({0x76E15D3EFEFDCBBF, 0xC5004E441C522FB3, 0x77710069854EE241, 0x39109BB02ACBE635});
+    }
+
+    const State &
+    getState() const
+    {
+        return s;
+    }
+
+    constexpr static result_type
+    min()
+    {
+        return 0;
+    }
+
+    constexpr static result_type
+    max()
+    {
+        return std::numeric_limits<result_type>::max();
+    }
+
+    bool
+    operator==(const Xoshiro256 & other) const = default;
+
+private:
+
+    constexpr static sp::Uint64
+    rotl(sp::Uint64 x, sp::Int32 k)
+    {
+        return (x << k) | (x >> (64 - k));
+    }
+
+    // The state after 2^k steps is a linear combination of the states
+    // of the next 256 steps, the polynomial x^(2^k) mod the
+    // characteristic polynomial gives its coefficients.
+    void
+    jump(const State & polynomial)
+    {
+        State res{};
+        for (sp::Uint64 word : polynomial)
+        {
+            for (sp::Int32 b = 0; b < 64; ++b)
+            {
+                if ((word >> b) & 1)
+                {
+                    for (sp::Int32 i = 0; i < 4; ++i)
+                    {
+                        res[i] ^= s[i];
+                    }
+                }
+
+                (*this)();
+            }
+        }
+
+        s = res;
+    }
+
+    State s;
+};
+
+} // namespace sp
+
+
+#endif // SPIRIT_XOSHIRO_HPP
@@ -0,0 +1,296 @@
+////////////////////////////////////////////////////////////
+//
+// Spirit
+// Copyright (C) 2022 Matthieu Beauchamp-Boulay
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it freely,
+// subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+////////////////////////////////////////////////////////////
+
+
+#ifndef SPIRIT_ZIGGURAT_HPP
+#define SPIRIT_ZIGGURAT_HPP
+
+#include "SPIRIT/Base.hpp"
+#include "SPIRIT/Math/Batch/Batch.hpp"
+#include "SPIRIT/Math/Random/Bulk.hpp"
+
+#include <array>
+#include <cmath>
+
+
+namespace sp
+{
+
+namespace details
+{
+
+// uniform double in [0, 1) from the 53 high bits of a 64 bits output
+template <class Engine>
+double
+unitDouble(Engine & engine)
+{
+    return static_cast<double>(engine() >> 11) * 0x1.0p-53;
+}
+
+
+////////////////////////////////////////////////////////////
+/// \brief Standard normal sampling with the Ziggurat method
+///
+/// Marsaglia and Tsang, "The Ziggurat Method for Generating Random Variables"
+/// (2000), with Doornik's independent bits for the layer and the value
+/// ("An Improved Ziggurat Method to Generate Normal Random Samples", 2005).
+///
+/// The normal density is covered by 256 layers of equal area. A word gives
+/// a layer and a signed uniform value, which is accepted without any further
+/// computation in about 99% of the draws. Only the rare rejections go
+/// through exp / log, one lane at a time in the bulk path.
+////////////////////////////////////////////////////////////
+template <class T>
+class Ziggurat
+{
+    static_assert(std::is_floating_point_v<T>);
+
+    typedef xsimd::as_unsigned_integer_t<T> Word;
+    typedef xsimd::as_integer_t<T> SignedWord;
+
+    constexpr static sp::Int32 nLayers = 256;
+
+    // start of the tail and area of each layer
+    constexpr static double r = 3.6541528853610088;
+    constexpr static double v = 4.92867323399e-3;
+
+    // the value uses the high bits, the layer the low ones
+    constexpr static sp::Int32 valueShift
+        = 8 * sizeof(Word) - std::numeric_limits<T>::digits;
+    constexpr static T valueScale
+        = T{1} / static_cast<T>(Word{1} << (std::numeric_limits<T>::digits - 1));
+
+    static_assert(valueShift >= 8, "Not enough bits left for the layer");
+
+public:
+
+    static const Ziggurat &
+    instance()
+    {
+        static const Ziggurat ziggurat{};
+        return ziggurat;
+    }
+
+    // one standard normal value
+    template <class Engine>
+    T
+    operator()(Engine & engine) const
+    {
+        while (true)
+        {
+            T res;
+            if (tryWord(engine, static_cast<Word>(engine()), res))
+            {
+                return res;
+            }
+        }
+    }
+
+    // n normal values of mean and stdDev, a SIMD batch at a time
+    template <class Arch = xsimd::default_arch, class Engine>
+    void
+    fill(Engine & engine, T * out, std::size_t n, T mean, T stdDev) const
+    {
+        typedef sp::details::Batch<T, Arch> Values;
+
+        const Values means{mean};
+        const Values stdDevs{stdDev};
+
+        sp::details::bulkFill<Arch>(engine, out, n, [&](const sp::Uint32 * words) {
+            return xsimd::fma(standardBatch<Arch>(engine, words), stdDevs, means);
+        });
+    }
+
+    // n rounded normal values of mean and stdDev
+    template <class Arch = xsimd::default_arch, class Engine>
+    void
+    fillRounded(Engine & engine, SignedWord * out, std::size_t n, T mean, T stdDev)
+        const
+    {
+        typedef sp::details::Batch<T, Arch> Values;
+
+        const Values means{mean};
+        const Values stdDevs{stdDev};
+
+        sp::details::bulkFill<Arch>(engine, out, n, [&](const sp::Uint32 * words) {
+            Values values
+                = xsimd::fma(standardBatch<Arch>(engine, words), stdDevs, means);
+            return xsimd::batch_cast<SignedWord>(xsimd::round(values));
+        });
+    }
+
+private:
+
+    Ziggurat()
+    {
+        auto f = [](double x) { return std::exp(-x * x / 2); };
+
+        std::array<double, nLayers + 1> x;
+        x[0]       = v / f(r);
+        x[1]       = r;
+        x[nLayers] = 0;
+        for (sp::Int32 i = 1; i < nLayers - 1; ++i)
+        {
+            x[i + 1] = std::sqrt(-2 * std::log(v / x[i] + f(x[i])));
+        }
+
+        for (sp::Int32 i = 0; i < nLayers; ++i)
+        {
+            xs[i]     = static_cast<T>(x[i]);
+            ratios[i] = static_cast<T>(x[i + 1] / x[i]);
+            fs[i]     = static_cast<T>(f(x[i]));
+        }
+
+        xs[nLayers] = 0;
+        fs[nLayers] = 1;
+    }
+
+    static T
+    valueOf(Word word)
+    {
+        // signed uniform in [-1, 1)
+        return static_cast<T>(static_cast<SignedWord>(word) >> valueShift) * valueScale;
+    }
+
+    // Sets res from word if it is accepted, the outer layers
+    // and the tail may draw more numbers from engine.
+    template <class Engine>
+    bool
+    tryWord(Engine & engine, Word word, T & res) const
+    {
+        sp::Int32 i = static_cast<sp::Int32>(word & (nLayers - 1));
+        T u         = valueOf(word);
+
+        if (std::abs(u) < ratios[i])
+        {
+            res = u * xs[i];
+            return true;
+        }
+
+        if (i == 0)
+        {
+            res = tail(engine, u < 0);
+            return true;
+        }
+
+        res = u * xs[i];
+        T y = static_cast<T>(unitDouble(engine));
+        return fs[i + 1] + y * (fs[i] - fs[i + 1]) < std::exp(-res * res / 2);
+    }
+
+    // Marsaglia's sampling of the tail beyond r
+    template <class Engine>
+    static T
+    tail(Engine & engine, bool negative)
+    {
+        double x, y;
+        do
+        {
+            x = -std::log(1 - unitDouble(engine)) / r;
+            y = -std::log(1 - unitDouble(engine));
+        } while (y + y < x * x);
+
+        return static_cast<T>(negative ? -(r + x) : r + x);
+    }
+
+    template <class Arch, class Engine>
+    sp::details::Batch<T, Arch>
+    standardBatch(Engine & engine, const sp::Uint32 * words) const
+    {
+        typedef sp::details::Batch<T, Arch> Values;
+        typedef sp::details::Batch<Word, Arch> Words;
+        typedef sp::details::Batch<SignedWord, Arch> SignedWords;
+
+        Words word
+            = xsimd::bitwise_cast<Word>(ArchWordBatch<Arch>::load_aligned(words));
+        SignedWords layer
+            = xsimd::bitwise_cast<SignedWord>(word & Words{nLayers - 1});
+        Values u = xsimd::batch_cast<T>(xsimd::bitwise_cast<SignedWord>(word) >> valueShift)
+                   * Values{valueScale};
+
+        Values res = u * Values::gather(xs.data(), layer);
+
+        // lanes outside of their layer's inner rectangle finish with the scalar path
+        auto rejected = xsimd::abs(u) >= Values::gather(ratios.data(), layer);
+        if (xsimd::any(rejected))
+        {
+            alignas(Arch::alignment()) T values[Values::size];
+            alignas(Arch::alignment()) Word laneWords[Values::size];
+            res.store_aligned(values);
+            word.store_aligned(laneWords);
+
+            sp::Uint64 mask = rejected.mask();
+            for (std::size_t l = 0; l < Values::size; ++l)
+            {
+                if (((mask >> l) & 1) && !tryWord(engine, laneWords[l], values[l]))
+                {
+                    values[l] = (*this)(engine);
+                }
+            }
+
+            res = Values::load_aligned(values);
+        }
+
+        return res;
+    }
+
+    std::array<T, nLayers + 1> xs;     // right edge of each layer
+    std::array<T, nLayers> ratios;     // x[i + 1] / x[i], fully inside below
+    std::array<T, nLayers + 1> fs;     // density at x[i]
+};
+
+
+////////////////////////////////////////////////////////////
+// The tables and the scalar path are compiled once, in spirit-math
+// (src/SPIRIT/Instantiation), so the units built for other instruction
+// sets (src/SPIRIT/Dispatch) only provide their own fill<Arch>.
+////////////////////////////////////////////////////////////
+
+extern template double
+unitDouble(sp::Philox & engine);
+
+extern template class Ziggurat<float>;
+extern template class Ziggurat<double>;
+
+extern template float
+Ziggurat<float>::operator()(sp::Philox & engine) const;
+extern template double
+Ziggurat<double>::operator()(sp::Philox & engine) const;
+
+extern template bool
+Ziggurat<float>::tryWord(sp::Philox & engine, Word word, float & res) const;
+extern template bool
+Ziggurat<double>::tryWord(sp::Philox & engine, Word word, double & res) const;
+
+extern template float
+Ziggurat<float>::tail(sp::Philox & engine, bool negative);
+extern template double
+Ziggurat<double>::tail(sp::Philox & engine, bool negative);
+
+} // namespace details
+
+} // namespace sp
+
+
+#endif // SPIRIT_ZIGGURAT_HPP
@@ -0,0 +1,780 @@
+////////////////////////////////////////////////////////////
+//
+// Spirit
+// Copyright (C) 2022 Matthieu Beauchamp-Boulay
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it freely,
+// subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+////////////////////////////////////////////////////////////
+
+
+#ifndef SPIRIT_STREAM_HPP
+#define SPIRIT_STREAM_HPP
+
+#include "SPIRIT/Base.hpp"
+#include "SPIRIT/Math/Batch/Batch.hpp"
+#include "SPIRIT/Math/Matrix/Matrix.hpp"
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+namespace sp
+{
+
+namespace details
+{
+
+template <class T, class Arch = xsimd::default_arch>
+using AlignedVector
+    = std::vector<T, xsimd::aligned_allocator<T, Arch::alignment()>>;
+
+} // namespace details
+
+
+////////////////////////////////////////////////////////////
+/// \brief Stores many matrices of the same size as a structure of arrays
+///
+/// Every coefficient of the stored matrices has its own lane
+/// (coefficient (r, c) of all matrices are contiguous in memory),
+/// so operations process sp::details::Batch<T>::size matrices at once
+/// instead of vectorizing a single small matrix.
+///
+/// Lanes are aligned to sp::details::Batch<T>::arch_type::alignment()
+/// and padded to a multiple of the batch size. The content of the padding
+/// is unspecified, operations are applied to it like any other element.
+///
+/// 2x2, 3x3 and 4x4 streams also have batched determinants and inverses,
+/// with a per-element invertibility mask.
+///
+/// \code
+/// sp::VecStream<float, 3> positions{100000};
+/// sp::VecStream<float, 3> velocities{100000};
+/// positions += velocities * dt;
+/// sp::VecStream<float, 1> speeds = velocities.norm();
+/// \endcode
+////////////////////////////////////////////////////////////
+template <class T, sp::Int32 mRows, sp::Int32 nCols>
+class MatStream
+{
+    constexpr static bool isColVector = nCols == 1;
+    constexpr static bool isRowVector = mRows == 1 && !isColVector;
+    constexpr static bool isVector    = isRowVector || isColVector;
+
+    constexpr static sp::Int32 nLanes = mRows * nCols;
+
+    constexpr static bool isSmallSquare = mRows == nCols && mRows >= 2 && mRows <= 4;
+
+    typedef sp::details::Batch<T> Batch;
+    typedef std::array<Batch, nLanes> Batches;
+
+public:
+
+    typedef sp::Matrix<T, mRows, nCols> value_type;
+
+    constexpr static std::size_t batchSize = Batch::size;
+
+    ////////////////////////////////////////////////////////////
+    // Construction and assignement
+    ////////////////////////////////////////////////////////////
+
+    MatStream() = default;
+
+    // elements are initialized to zero
+    explicit MatStream(std::size_t size) { resize(size); }
+
+    template <class IterType>
+    MatStream(IterType begin, IterType end)
+    {
+        reserve(std::distance(begin, end));
+        for (auto it = begin; it != end; ++it)
+        {
+            push_back(*it);
+        }
+    }
+
+    MatStream(std::initializer_list<value_type> values)
+        : MatStream{values.begin(), values.end()}
+    {
+    }
+
+    MatStream(const MatStream &) = default;
+    MatStream(MatStream &&)      = default;
+
+    MatStream &
+    operator=(const MatStream &)
+        = default;
+
+    MatStream &
+    operator=(MatStream &&)
+        = default;
+
+    ////////////////////////////////////////////////////////////
+    // Size
+    ////////////////////////////////////////////////////////////
+
+    std::size_t
+    size() const
+    {
+        return count;
+    }
+
+    bool
+    empty() const
+    {
+        return count == 0;
+    }
+
+    // new elements are initialized to zero
+    void
+    resize(std::size_t size)
+    {
+        reallocate(size, std::max(size, stride));
+        count = size;
+    }
+
+    void
+    reserve(std::size_t capacity)
+    {
+        if (capacity > stride)
+        {
+            reallocate(count, capacity);
+        }
+    }
+
+    void
+    clear()
+    {
+        count = 0;
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Element access
+    ////////////////////////////////////////////////////////////
+
+    value_type
+    get(std::size_t index) const
+    {
+        SPIRIT_ASSERT(index < count)
+
+        value_type value;
+        for (sp::Int32 c = 0; c < nCols; ++c)
+        {
+            for (sp::Int32 r = 0; r < mRows; ++r)
+            {
+                value(r, c) = lane(r, c)[index];
+            }
+        }
+
+        return value;
+    }
+
+    void
+    set(std::size_t index, const value_type & value)
+    {
+        SPIRIT_ASSERT(index < count)
+
+        for (sp::Int32 c = 0; c < nCols; ++c)
+        {
+            for (sp::Int32 r = 0; r < mRows; ++r)
+            {
+                lane(r, c)[index] = value(r, c);
+            }
+        }
+    }
+
+    void
+    push_back(const value_type & value)
+    {
+        if (count == stride)
+        {
+            reallocate(count, std::max<std::size_t>(2 * stride, batchSize));
+        }
+
+        ++count;
+        set(count - 1, value);
+    }
+
+    value_type
+    operator[](std::size_t index) const
+    {
+        return get(index);
+    }
+
+    // Contiguous values of coefficient (row, col) of every element.
+    // Aligned and padded to a multiple of batchSize.
+    T *
+    lane(sp::Int32 row, sp::Int32 col)
+    {
+        return data.data() + laneIndex(row, col) * stride;
+    }
+
+    const T *
+    lane(sp::Int32 row, sp::Int32 col) const
+    {
+        return data.data() + laneIndex(row, col) * stride;
+    }
+
+    T *
+    lane(sp::Int32 index)
+    {
+        static_assert(isVector, "Disabled for matrices, use lane(row, column)");
+        return data.data() + index * stride;
+    }
+
+    const T *
+    lane(sp::Int32 index) const
+    {
+        static_assert(isVector, "Disabled for matrices, use lane(row, column)");
+        return data.data() + index * stride;
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Component wise operators
+    ////////////////////////////////////////////////////////////
+
+    MatStream
+    operator+(const MatStream & other) const
+    {
+        MatStream res{*this};
+        res += other;
+        return res;
+    }
+
+    MatStream &
+    operator+=(const MatStream & other)
+    {
+        SPIRIT_ASSERT(count == other.count)
+
+        forEachBatch([&](std::size_t i) {
+            for (sp::Int32 l = 0; l < nLanes; ++l)
+            {
+                store(l, i, load(l, i) + other.load(l, i));
+            }
+        });
+
+        return *this;
+    }
+
+    MatStream
+    operator-(const MatStream & other) const
+    {
+        MatStream res{*this};
+        res -= other;
+        return res;
+    }
+
+    MatStream &
+    operator-=(const MatStream & other)
+    {
+        SPIRIT_ASSERT(count == other.count)
+
+        forEachBatch([&](std::size_t i) {
+            for (sp::Int32 l = 0; l < nLanes; ++l)
+            {
+                store(l, i, load(l, i) - other.load(l, i));
+            }
+        });
+
+        return *this;
+    }
+
+    MatStream
+    operator*(T scalar) const
+    {
+        MatStream res{*this};
+        res *= scalar;
+        return res;
+    }
+
+    friend MatStream
+    operator*(T scalar, const MatStream & stream)
+    {
+        return stream * scalar;
+    }
+
+    MatStream &
+    operator*=(T scalar)
+    {
+        Batch s{scalar};
+        forEachBatch([&](std::size_t i) {
+            for (sp::Int32 l = 0; l < nLanes; ++l)
+            {
+                store(l, i, load(l, i) * s);
+            }
+        });
+
+        return *this;
+    }
+
+    MatStream
+    operator/(T scalar) const
+    {
+        MatStream res{*this};
+        res /= scalar;
+        return res;
+    }
+
+    MatStream &
+    operator/=(T scalar)
+    {
+        Batch s{scalar};
+        forEachBatch([&](std::size_t i) {
+            for (sp::Int32 l = 0; l < nLanes; ++l)
+            {
+                store(l, i, load(l, i) / s);
+            }
+        });
+
+        return *this;
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Matrix products
+    ////////////////////////////////////////////////////////////
+
+    // Element-wise matrix product, res[i] = (*this)[i] * other[i]
+    template <sp::Int32 nColsOther>
+    MatStream<T, mRows, nColsOther>
+    operator*(const MatStream<T, nCols, nColsOther> & other) const
+    {
+        SPIRIT_ASSERT(count == other.count)
+
+        MatStream<T, mRows, nColsOther> res(count);
+        forEachBatch([&](std::size_t i) {
+            Batches a = loadAll(i);
+            auto b   = other.loadAll(i);
+
+            for (sp::Int32 c = 0; c < nColsOther; ++c)
+            {
+                for (sp::Int32 r = 0; r < mRows; ++r)
+                {
+                    Batch sum = a[laneIndex(r, 0)] * b[other.laneIndex(0, c)];
+                    for (sp::Int32 k = 1; k < nCols; ++k)
+                    {
+                        sum = xsimd::fma(
+                            a[laneIndex(r, k)],
+                            b[other.laneIndex(k, c)],
+                            sum
+                        );
+                    }
+                    res.store(res.laneIndex(r, c), i, sum);
+                }
+            }
+        });
+
+        return res;
+    }
+
+    // Applies the same matrix to every element, res[i] = mat * stream[i]
+    template <sp::Int32 mRowsOther>
+    friend MatStream<T, mRowsOther, nCols>
+    operator*(const sp::Matrix<T, mRowsOther, mRows> & mat, const MatStream & stream)
+    {
+        return stream.leftMultiplied(mat);
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Vector operations
+    ////////////////////////////////////////////////////////////
+
+    MatStream<T, 1, 1>
+    dot(const MatStream & other) const
+    {
+        static_assert(isVector, "Must be a vector type");
+        SPIRIT_ASSERT(count == other.count)
+
+        MatStream<T, 1, 1> res(count);
+        forEachBatch([&](std::size_t i) {
+            Batch sum = load(0, i) * other.load(0, i);
+            for (sp::Int32 l = 1; l < nLanes; ++l)
+            {
+                sum = xsimd::fma(load(l, i), other.load(l, i), sum);
+            }
+            res.store(0, i, sum);
+        });
+
+        return res;
+    }
+
+    // 2D cross product, res[i] = x1 * y2 - y1 * x2
+    MatStream<T, 1, 1>
+    cross(const MatStream & other) const
+        requires(nLanes == 2)
+    {
+        SPIRIT_ASSERT(count == other.count)
+
+        MatStream<T, 1, 1> res(count);
+        forEachBatch([&](std::size_t i) {
+            res.store(
+                0,
+                i,
+                xsimd::fms(load(0, i), other.load(1, i), load(1, i) * other.load(0, i))
+            );
+        });
+
+        return res;
+    }
+
+    MatStream
+    cross(const MatStream & other) const
+        requires(nLanes == 3)
+    {
+        SPIRIT_ASSERT(count == other.count)
+
+        MatStream res(count);
+        forEachBatch([&](std::size_t i) {
+            Batches a = loadAll(i);
+            Batches b = other.loadAll(i);
+
+            res.store(0, i, xsimd::fms(a[1], b[2], a[2] * b[1]));
+            res.store(1, i, xsimd::fms(a[2], b[0], a[0] * b[2]));
+            res.store(2, i, xsimd::fms(a[0], b[1], a[1] * b[0]));
+        });
+
+        return res;
+    }
+
+    MatStream<T, 1, 1>
+    squaredNorm() const
+    {
+        return dot(*this);
+    }
+
+    MatStream<T, 1, 1>
+    norm() const
+    {
+        static_assert(isVector, "Must be a vector type");
+
+        MatStream<T, 1, 1> res(count);
+        forEachBatch([&](std::size_t i) {
+            res.store(0, i, xsimd::sqrt(squaredNormOf(i)));
+        });
+
+        return res;
+    }
+
+    // elements with norm == 0 are unchanged
+    void
+    normalize()
+    {
+        static_assert(isVector, "Must be a vector type");
+
+        forEachBatch([&](std::size_t i) {
+            Batch n = xsimd::sqrt(squaredNormOf(i));
+            Batch invNorm
+                = xsimd::select(n == Batch{0}, Batch{1}, Batch{1} / n);
+
+            for (sp::Int32 l = 0; l < nLanes; ++l)
+            {
+                store(l, i, load(l, i) * invNorm);
+            }
+        });
+    }
+
+    // elements with norm == 0 are unchanged
+    MatStream
+    normalized() const
+    {
+        MatStream res{*this};
+        res.normalize();
+        return res;
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Square matrix operations (2x2, 3x3 and 4x4)
+    ////////////////////////////////////////////////////////////
+
+    MatStream<T, 1, 1>
+    determinant() const
+        requires isSmallSquare
+    {
+        MatStream<T, 1, 1> res(count);
+        forEachBatch([&](std::size_t i) {
+            Batches adjugate;
+            res.store(0, i, adjugateOf(loadAll(i), adjugate));
+        });
+
+        return res;
+    }
+
+    // Inverts every element in place. Returns whether each element was
+    // invertible, non invertible elements are left unchanged.
+    std::vector<bool>
+    inverse()
+        requires isSmallSquare
+    {
+        std::vector<bool> wasInversed(count);
+        forEachBatch([&](std::size_t i) {
+            Batches a = loadAll(i);
+            Batches adjugate;
+            Batch det = adjugateOf(a, adjugate);
+
+            auto invertible = xsimd::abs(det) > Batch{Eigen::NumTraits<T>::dummy_precision()};
+            Batch invDet = xsimd::select(invertible, Batch{1} / det, Batch{0});
+            for (sp::Int32 l = 0; l < nLanes; ++l)
+            {
+                store(l, i, xsimd::select(invertible, adjugate[l] * invDet, a[l]));
+            }
+
+            sp::Uint64 bits = invertible.mask();
+            for (std::size_t b = 0; b < batchSize && i + b < count; ++b)
+            {
+                wasInversed[i + b] = (bits >> b) & 1;
+            }
+        });
+
+        return wasInversed;
+    }
+
+    [[nodiscard]] MatStream
+    inversed(std::vector<bool> & wasInversed) const
+        requires isSmallSquare
+    {
+        MatStream res{*this};
+        wasInversed = res.inverse();
+        return res;
+    }
+
+private:
+
+    template <class U, sp::Int32 mRowsOther, sp::Int32 nColsOther>
+    friend class MatStream;
+
+    constexpr static sp::Int32
+    laneIndex(sp::Int32 row, sp::Int32 col)
+    {
+        // column major, like sp::Matrix
+        return col * mRows + row;
+    }
+
+    static std::size_t
+    padded(std::size_t size)
+    {
+        return (size + batchSize - 1) / batchSize * batchSize;
+    }
+
+    void
+    reallocate(std::size_t size, std::size_t capacity)
+    {
+        std::size_t newStride = padded(capacity);
+        if (newStride == stride)
+        {
+            // zero the elements that are becoming visible
+            for (sp::Int32 l = 0; l < nLanes; ++l)
+            {
+                T * first = data.data() + l * stride;
+                std::fill(first + std::min(count, size), first + size, T{0});
+            }
+            return;
+        }
+
+        sp::details::AlignedVector<T> newData(newStride * nLanes, T{0});
+        for (sp::Int32 l = 0; l < nLanes; ++l)
+        {
+            std::copy_n(
+                data.data() + l * stride,
+                std::min(count, size),
+                newData.data() + l * newStride
+            );
+        }
+
+        data   = std::move(newData);
+        stride = newStride;
+    }
+
+    template <class Kernel>
+    void
+    forEachBatch(Kernel && kernel) const
+    {
+        std::size_t end = padded(count);
+        for (std::size_t i = 0; i < end; i += batchSize)
+        {
+            kernel(i);
+        }
+    }
+
+    Batch
+    load(sp::Int32 laneIdx, std::size_t i) const
+    {
+        return Batch::load_aligned(data.data() + laneIdx * stride + i);
+    }
+
+    Batches
+    loadAll(std::size_t i) const
+    {
+        Batches batches;
+        for (sp::Int32 l = 0; l < nLanes; ++l)
+        {
+            batches[l] = load(l, i);
+        }
+
+        return batches;
+    }
+
+    void
+    store(sp::Int32 laneIdx, std::size_t i, const Batch & batch)
+    {
+        batch.store_aligned(data.data() + laneIdx * stride + i);
+    }
+
+    template <sp::Int32 mRowsOther>
+    MatStream<T, mRowsOther, nCols>
+    leftMultiplied(const sp::Matrix<T, mRowsOther, mRows> & mat) const
+    {
+        MatStream<T, mRowsOther, nCols> res(count);
+        forEachBatch([&](std::size_t i) {
+            Batches b = loadAll(i);
+
+            for (sp::Int32 c = 0; c < nCols; ++c)
+            {
+                for (sp::Int32 r = 0; r < mRowsOther; ++r)
+                {
+                    Batch sum = Batch{mat(r, 0)} * b[laneIndex(0, c)];
+                    for (sp::Int32 k = 1; k < mRows; ++k)
+                    {
+                        sum = xsimd::fma(Batch{mat(r, k)}, b[laneIndex(k, c)], sum);
+                    }
+                    res.store(res.laneIndex(r, c), i, sum);
+                }
+            }
+        });
+
+        return res;
+    }
+
+    // Sets adj to the adjugate (transposed cofactors) of a and returns
+    // the determinant of a, inverse(a) = adj / det.
+    static Batch
+    adjugateOf(const Batches & a, Batches & adj)
+        requires isSmallSquare
+    {
+        auto at = [&](sp::Int32 r, sp::Int32 c) -> const Batch & {
+            return a[laneIndex(r, c)];
+        };
+        auto set = [&](sp::Int32 r, sp::Int32 c, const Batch & value) {
+            adj[laneIndex(r, c)] = value;
+        };
+
+        if constexpr (mRows == 2)
+        {
+            set(0, 0, at(1, 1));
+            set(0, 1, -at(0, 1));
+            set(1, 0, -at(1, 0));
+            set(1, 1, at(0, 0));
+            return xsimd::fms(at(0, 0), at(1, 1), at(0, 1) * at(1, 0));
+        }
+        else if constexpr (mRows == 3)
+        {
+            // cyclic indices give the cofactors with their sign
+            for (sp::Int32 r = 0; r < 3; ++r)
+            {
+                for (sp::Int32 c = 0; c < 3; ++c)
+                {
+                    sp::Int32 r1 = (r + 1) % 3, r2 = (r + 2) % 3;
+                    sp::Int32 c1 = (c + 1) % 3, c2 = (c + 2) % 3;
+                    set(c, r, xsimd::fms(at(r1, c1), at(r2, c2), at(r1, c2) * at(r2, c1)));
+                }
+            }
+
+            Batch det = at(0, 0) * adj[laneIndex(0, 0)];
+            det       = xsimd::fma(at(0, 1), adj[laneIndex(1, 0)], det);
+            return xsimd::fma(at(0, 2), adj[laneIndex(2, 0)], det);
+        }
+        else
+        {
+            // Laplace expansion on the 2x2 minors of the top and bottom rows,
+            // see Eberly, "The Laplace Expansion Theorem" (2008)
+            auto minor = [&](sp::Int32 r, sp::Int32 c0, sp::Int32 c1) {
+                return xsimd::fms(at(r, c0), at(r + 1, c1), at(r + 1, c0) * at(r, c1));
+            };
+
+            Batch s0 = minor(0, 0, 1), s1 = minor(0, 0, 2), s2 = minor(0, 0, 3);
+            Batch s3 = minor(0, 1, 2), s4 = minor(0, 1, 3), s5 = minor(0, 2, 3);
+            Batch c0 = minor(2, 0, 1), c1 = minor(2, 0, 2), c2 = minor(2, 0, 3);
+            Batch c3 = minor(2, 1, 2), c4 = minor(2, 1, 3), c5 = minor(2, 2, 3);
+
+            // x * y - z * w + u * v
+            auto expand = [](const Batch & x, const Batch & y, const Batch & z,
+                             const Batch & w, const Batch & u, const Batch & v) {
+                return xsimd::fma(u, v, xsimd::fms(x, y, z * w));
+            };
+
+            set(0, 0, expand(at(1, 1), c5, at(1, 2), c4, at(1, 3), c3));
+            set(0, 1, -expand(at(0, 1), c5, at(0, 2), c4, at(0, 3), c3));
+            set(0, 2, expand(at(3, 1), s5, at(3, 2), s4, at(3, 3), s3));
+            set(0, 3, -expand(at(2, 1), s5, at(2, 2), s4, at(2, 3), s3));
+
+            set(1, 0, -expand(at(1, 0), c5, at(1, 2), c2, at(1, 3), c1));
+            set(1, 1, expand(at(0, 0), c5, at(0, 2), c2, at(0, 3), c1));
+            set(1, 2, -expand(at(3, 0), s5, at(3, 2), s2, at(3, 3), s1));
+            set(1, 3, expand(at(2, 0), s5, at(2, 2), s2, at(2, 3), s1));
+
+            set(2, 0, expand(at(1, 0), c4, at(1, 1), c2, at(1, 3), c0));
+            set(2, 1, -expand(at(0, 0), c4, at(0, 1), c2, at(0, 3), c0));
+            set(2, 2, expand(at(3, 0), s4, at(3, 1), s2, at(3, 3), s0));
+            set(2, 3, -expand(at(2, 0), s4, at(2, 1), s2, at(2, 3), s0));
+
+            set(3, 0, -expand(at(1, 0), c3, at(1, 1), c1, at(1, 2), c0));
+            set(3, 1, expand(at(0, 0), c3, at(0, 1), c1, at(0, 2), c0));
+            set(3, 2, -expand(at(3, 0), s3, at(3, 1), s1, at(3, 2), s0));
+            set(3, 3, expand(at(2, 0), s3, at(2, 1), s1, at(2, 2), s0));
+
+            Batch det = xsimd::fms(s0, c5, s1 * c4);
+            det       = xsimd::fma(s2, c3, det);
+            det       = xsimd::fma(s3, c2, det);
+            det       = xsimd::fnma(s4, c1, det);
+            return xsimd::fma(s5, c0, det);
+        }
+    }
+
+    Batch
+    squaredNormOf(std::size_t i) const
+    {
+        Batch b   = load(0, i);
+        Batch sum = b * b;
+        for (sp::Int32 l = 1; l < nLanes; ++l)
+        {
+            b   = load(l, i);
+            sum = xsimd::fma(b, b, sum);
+        }
+
+        return sum;
+    }
+
+    sp::details::AlignedVector<T> data{};
+    std::size_t stride = 0; // padded capacity of each lane
+    std::size_t count  = 0;
+};
+
+
+template <class T, sp::Int32 dim>
+using VecStream = sp::MatStream<T, dim, 1>;
+
+typedef sp::VecStream<float, 2> Vec2Stream;
+typedef sp::VecStream<float, 3> Vec3Stream;
+typedef sp::VecStream<float, 4> Vec4Stream;
+
+typedef sp::MatStream<float, 2, 2> Mat2Stream;
+typedef sp::MatStream<float, 3, 3> Mat3Stream;
+typedef sp::MatStream<float, 4, 4> Mat4Stream;
+
+} // namespace sp
+
+
+#endif // SPIRIT_STREAM_HPP
@@ -0,0 +1,242 @@
+////////////////////////////////////////////////////////////
+//
+// Spirit
+// Copyright (C) 2022 Matthieu Beauchamp-Boulay
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it freely,
+// subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+////////////////////////////////////////////////////////////
+
+
+#ifndef SPIRIT_TRANSFORM_BULK_HPP
+#define SPIRIT_TRANSFORM_BULK_HPP
+
+#include "SPIRIT/Base.hpp"
+#include "SPIRIT/Math/Batch/Batch.hpp"
+
+#include <array>
+
+
+////////////////////////////////////////////////////////////
+// Vectorized application of affine transformations, see
+// Transformation::applyTo.
+//
+// The kernels take the coefficients of the affine part (dim x (dim + 1),
+// column major) instead of a Transformation, and the target Arch as their
+// first template parameter so they can be compiled for several instruction
+// sets, see Dispatch.hpp. The scalar tails do not go through Eigen for the
+// same reason.
+////////////////////////////////////////////////////////////
+
+namespace sp
+{
+
+namespace details
+{
+
+template <class T, sp::Int32 dim>
+using AffineCoeffs = std::array<T, dim*(dim + 1)>;
+
+template <class T, sp::Int32 dim, class Arch = xsimd::default_arch>
+using VectorLanes = std::array<sp::details::Batch<T, Arch>, dim>;
+
+// m * v, with the translation if isPoint
+template <bool isPoint, class T, sp::Int32 dim, class Arch>
+VectorLanes<T, dim, Arch>
+transformLanes(
+    const std::array<sp::details::Batch<T, Arch>, dim*(dim + 1)> & m,
+    const VectorLanes<T, dim, Arch> & v
+)
+{
+    VectorLanes<T, dim, Arch> res;
+    for (sp::Int32 r = 0; r < dim; ++r)
+    {
+        sp::details::Batch<T, Arch> sum = isPoint ? xsimd::fma(m[r], v[0], m[dim * dim + r])
+                                                  : m[r] * v[0];
+        for (sp::Int32 k = 1; k < dim; ++k)
+        {
+            sum = xsimd::fma(m[k * dim + r], v[k], sum);
+        }
+        res[r] = sum;
+    }
+
+    return res;
+}
+
+// Arch only keeps the copies compiled for each instruction set apart
+template <bool isPoint, class Arch, class T, sp::Int32 dim>
+void
+transformScalar(const T * m, const T * src, T * dst)
+{
+    T v[dim];
+    for (sp::Int32 r = 0; r < dim; ++r)
+    {
+        T sum = isPoint ? m[dim * dim + r] : T{0};
+        for (sp::Int32 k = 0; k < dim; ++k)
+        {
+            sum += m[k * dim + r] * src[k];
+        }
+        v[r] = sum;
+    }
+
+    for (sp::Int32 r = 0; r < dim; ++r)
+    {
+        dst[r] = v[r];
+    }
+}
+
+template <bool isPoint, class Arch, class T, sp::Int32 dim>
+void
+packedKernel(const T * affine, const T * src, T * dst, std::size_t n)
+{
+    typedef sp::details::Batch<T, Arch> Batch;
+    typedef sp::details::Batch<xsimd::as_integer_t<T>, Arch> IndexBatch;
+    static_assert(IndexBatch::size == Batch::size);
+
+    alignas(Arch::alignment()) xsimd::as_integer_t<T> offsets[Batch::size];
+    for (std::size_t l = 0; l < Batch::size; ++l)
+    {
+        offsets[l] = static_cast<xsimd::as_integer_t<T>>(l * dim);
+    }
+    const IndexBatch indices = IndexBatch::load_aligned(offsets);
+
+    std::array<Batch, dim*(dim + 1)> m;
+    for (sp::Int32 k = 0; k < dim * (dim + 1); ++k)
+    {
+        m[k] = Batch{affine[k]};
+    }
+
+    std::size_t i = 0;
+    for (; i + Batch::size <= n; i += Batch::size)
+    {
+        VectorLanes<T, dim, Arch> v;
+        for (sp::Int32 k = 0; k < dim; ++k)
+        {
+            v[k] = Batch::gather(src + i * dim + k, indices);
+        }
+
+        v = transformLanes<isPoint, T, dim, Arch>(m, v);
+        for (sp::Int32 k = 0; k < dim; ++k)
+        {
+            v[k].scatter(dst + i * dim + k, indices);
+        }
+    }
+
+    for (; i < n; ++i)
+    {
+        transformScalar<isPoint, Arch, T, dim>(affine, src + i * dim, dst + i * dim);
+    }
+}
+
+////////////////////////////////////////////////////////////
+/// \brief Transforms n tightly packed vectors (x0, y0, x1, y1, ...)
+///
+/// dst may be src. The translation is applied if isPoint.
+////////////////////////////////////////////////////////////
+template <class Arch, class T, sp::Int32 dim>
+void
+transformPacked(const T * affine, const T * src, T * dst, std::size_t n, bool isPoint)
+{
+    if (isPoint)
+    {
+        packedKernel<true, Arch, T, dim>(affine, src, dst, n);
+    }
+    else
+    {
+        packedKernel<false, Arch, T, dim>(affine, src, dst, n);
+    }
+}
+
+template <bool isPoint, class Arch, class T, sp::Int32 dim>
+void
+splitKernel(const T * affine, const T * const * src, T * const * dst, std::size_t n)
+{
+    typedef sp::details::Batch<T, Arch> Batch;
+
+    std::array<Batch, dim*(dim + 1)> m;
+    for (sp::Int32 k = 0; k < dim * (dim + 1); ++k)
+    {
+        m[k] = Batch{affine[k]};
+    }
+
+    std::size_t i = 0;
+    for (; i + Batch::size <= n; i += Batch::size)
+    {
+        VectorLanes<T, dim, Arch> v;
+        for (sp::Int32 k = 0; k < dim; ++k)
+        {
+            v[k] = Batch::load_unaligned(src[k] + i);
+        }
+
+        v = transformLanes<isPoint, T, dim, Arch>(m, v);
+        for (sp::Int32 k = 0; k < dim; ++k)
+        {
+            v[k].store_unaligned(dst[k] + i);
+        }
+    }
+
+    for (; i < n; ++i)
+    {
+        T v[dim];
+        for (sp::Int32 k = 0; k < dim; ++k)
+        {
+            v[k] = src[k][i];
+        }
+
+        transformScalar<isPoint, Arch, T, dim>(affine, v, v);
+        for (sp::Int32 k = 0; k < dim; ++k)
+        {
+            dst[k][i] = v[k];
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////
+/// \brief Transforms n vectors split by coordinate, src[k][i] is
+/// the k-th coordinate of the i-th vector
+///
+/// The lanes of dst may be the ones of src. The translation is applied if isPoint.
+/// Lanes need not be aligned for Arch: streams are padded and aligned
+/// for xsimd::default_arch, which may be narrower.
+////////////////////////////////////////////////////////////
+template <class Arch, class T, sp::Int32 dim>
+void
+transformSplit(
+    const T * affine,
+    const T * const * src,
+    T * const * dst,
+    std::size_t n,
+    bool isPoint
+)
+{
+    if (isPoint)
+    {
+        splitKernel<true, Arch, T, dim>(affine, src, dst, n);
+    }
+    else
+    {
+        splitKernel<false, Arch, T, dim>(affine, src, dst, n);
+    }
+}
+
+} // namespace details
+
+} // namespace sp
+
+
+#endif // SPIRIT_TRANSFORM_BULK_HPP
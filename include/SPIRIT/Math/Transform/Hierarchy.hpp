@@ -0,0 +1,443 @@
+////////////////////////////////////////////////////////////
+//
+// Spirit
+// Copyright (C) 2022 Matthieu Beauchamp-Boulay
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it freely,
+// subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+////////////////////////////////////////////////////////////
+
+
+#ifndef SPIRIT_HIERARCHY_HPP
+#define SPIRIT_HIERARCHY_HPP
+
+#include "SPIRIT/Base.hpp"
+#include "SPIRIT/Math/Batch/Batch.hpp"
+#include "SPIRIT/Math/Parallel/Parallel.hpp"
+#include "SPIRIT/Math/Transform/Transform.hpp"
+
+#include <algorithm>
+#include <array>
+#include <numeric>
+#include <vector>
+
+
+namespace sp
+{
+
+////////////////////////////////////////////////////////////
+/// \brief Tree of transformations, such as a scene graph or a skeleton
+///
+/// Each node has a local transformation, relative to its parent, and a world
+/// transformation: world(node) = world(parent) * local(node).
+///
+/// Nodes are stored in flat arrays, a parent is always added before its
+/// children. update() only recomputes the world transformations of the nodes
+/// whose local transformation changed and of their descendants.
+/// Nodes of the same depth do not depend on each other, they are updated
+/// a SIMD batch at a time. With sp::Execution::Parallel, the outdated subtrees
+/// are split among threads, which update them from the top down.
+///
+/// \code
+/// sp::TransformHierarchy3D skeleton{};
+/// auto hips  = skeleton.add(hipsPose);
+/// auto spine = skeleton.add(spinePose, hips);
+/// ...
+/// skeleton.setLocal(spine, newSpinePose);
+/// skeleton.update(); // spine and its descendants only
+/// skeleton.world(spine);
+/// \endcode
+///
+/// Nodes cannot be removed.
+////////////////////////////////////////////////////////////
+template <class T, sp::Int32 dim, TransformStorage storage = TransformStorage::Affine>
+class TransformationHierarchy
+{
+    typedef Transformation<T, dim, storage> Trans;
+
+    typedef sp::details::Batch<T> Batch;
+    typedef xsimd::as_integer_t<T> Index;
+    typedef sp::details::Batch<Index> IndexBatch;
+
+    // rows of the matrix that are stored, the last one is not part of the products
+    constexpr static sp::Int32 nStoredRows
+        = storage == TransformStorage::Affine ? dim + 1 : dim;
+
+    // distance between the coefficients of consecutive transformations
+    constexpr static sp::Int32 stride = sizeof(Trans) / sizeof(T);
+
+    static_assert(sizeof(Trans) % sizeof(T) == 0);
+    static_assert(IndexBatch::size == Batch::size);
+
+    // Minimum number of nodes given to a thread. Each costs a product of
+    // affine transformations, far more than the elements of the bulk
+    // operations sp::details::parallelGrainSize is meant for.
+    constexpr static std::size_t grainSize = sp::details::parallelGrainSize / 16;
+
+public:
+
+    typedef sp::Int32 Node;
+
+    constexpr static Node noParent = -1;
+
+    // Adds a node under parent (a root by default), returns its index.
+    // Its world transformation is computed by the next update.
+    Node
+    add(const Trans & local, Node parent = noParent)
+    {
+        SPIRIT_ASSERT(parent == noParent || (0 <= parent && parent < size()))
+
+        Node node = size();
+        std::size_t depth = parent == noParent ? 0 : depths[parent] + 1;
+        if (depth == levels.size())
+        {
+            levels.emplace_back();
+        }
+
+        locals.push_back(local);
+        worlds.push_back(Trans{});
+        parents.push_back(parent);
+        depths.push_back(static_cast<sp::Int32>(depth));
+        levels[depth].push_back(node);
+        dirty.push_back(true);
+        changed.push_back(false);
+
+        return node;
+    }
+
+    Node
+    size() const
+    {
+        return static_cast<Node>(locals.size());
+    }
+
+    Node
+    parent(Node node) const
+    {
+        return parents[node];
+    }
+
+    // 0 for roots
+    sp::Int32
+    depth(Node node) const
+    {
+        return depths[node];
+    }
+
+    const Trans &
+    local(Node node) const
+    {
+        return locals[node];
+    }
+
+    // node and its descendants are recomputed by the next update
+    void
+    setLocal(Node node, const Trans & local)
+    {
+        locals[node] = local;
+        dirty[node]  = true;
+    }
+
+    // as of the last update
+    const Trans &
+    world(Node node) const
+    {
+        return worlds[node];
+    }
+
+    // Recomputes the outdated world transformations,
+    // returns the number of nodes that were recomputed.
+    std::size_t
+    update(sp::Execution execution = sp::Execution::Sequential)
+    {
+        std::size_t nUpdated = collectOutdated();
+
+        std::size_t nThreads = sp::details::threadCount(nUpdated, execution, grainSize);
+        if (nThreads == 1)
+        {
+            updateLevels(outdated, sp::Execution::Sequential);
+            return nUpdated;
+        }
+
+        std::size_t largest = 0;
+        for (const Subtree & subtree : subtrees)
+        {
+            largest = std::max(largest, subtree.size);
+        }
+
+        // a subtree larger than the share of a thread, split each depth instead
+        if (largest * nThreads > nUpdated)
+        {
+            updateLevels(outdated, execution);
+        }
+        else
+        {
+            updateSubtrees(nThreads);
+        }
+
+        return nUpdated;
+    }
+
+private:
+
+    typedef std::array<Batch, dim*(dim + 1)> AffineBatches;
+
+    // outdated nodes whose parent is up to date, and their outdated descendants
+    struct Subtree
+    {
+        std::size_t size;
+        std::size_t thread;
+    };
+
+    // Fills outdated with the nodes to recompute, depth by depth,
+    // and groups them in subtrees. Returns the number of nodes to recompute.
+    std::size_t
+    collectOutdated()
+    {
+        std::fill(changed.begin(), changed.end(), false);
+        outdated.resize(levels.size());
+        subtrees.clear();
+        subtreeOf.resize(locals.size());
+
+        std::size_t nOutdated = 0;
+        for (std::size_t depth = 0; depth < levels.size(); ++depth)
+        {
+            outdated[depth].clear();
+            for (Node node : levels[depth])
+            {
+                bool parentChanged = depth > 0 && changed[parents[node]];
+                if (!dirty[node] && !parentChanged)
+                {
+                    continue;
+                }
+
+                outdated[depth].push_back(node);
+                changed[node] = true;
+                dirty[node]   = false;
+
+                if (parentChanged)
+                {
+                    subtreeOf[node] = subtreeOf[parents[node]];
+                    ++subtrees[subtreeOf[node]].size;
+                }
+                else
+                {
+                    subtreeOf[node] = subtrees.size();
+                    subtrees.push_back({1, 0});
+                }
+            }
+
+            nOutdated += outdated[depth].size();
+        }
+
+        return nOutdated;
+    }
+
+    // nodes[d] holds nodes of depth d, their parents are up to date
+    // once nodes[d - 1] are
+    void
+    updateLevels(const std::vector<std::vector<Node>> & nodes, sp::Execution execution)
+    {
+        for (std::size_t depth = 0; depth < nodes.size(); ++depth)
+        {
+            if (depth == 0)
+            {
+                for (Node root : nodes[depth])
+                {
+                    worlds[root] = locals[root];
+                }
+            }
+            else
+            {
+                updateLevel(nodes[depth], execution);
+            }
+        }
+    }
+
+    // each thread updates its own subtrees, they do not depend on each other
+    void
+    updateSubtrees(std::size_t nThreads)
+    {
+        // the largest subtrees first, each to the least loaded thread
+        std::vector<std::size_t> order(subtrees.size());
+        std::iota(order.begin(), order.end(), std::size_t{0});
+        std::sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+            return subtrees[a].size > subtrees[b].size;
+        });
+
+        std::vector<std::size_t> loads(nThreads, 0);
+        for (std::size_t subtree : order)
+        {
+            auto thread = std::min_element(loads.begin(), loads.end()) - loads.begin();
+            subtrees[subtree].thread = static_cast<std::size_t>(thread);
+            loads[thread] += subtrees[subtree].size;
+        }
+
+        tasks.resize(nThreads);
+        for (std::vector<std::vector<Node>> & task : tasks)
+        {
+            task.resize(levels.size());
+            for (std::vector<Node> & nodes : task)
+            {
+                nodes.clear();
+            }
+        }
+
+        for (std::size_t depth = 0; depth < outdated.size(); ++depth)
+        {
+            for (Node node : outdated[depth])
+            {
+                tasks[subtrees[subtreeOf[node]].thread][depth].push_back(node);
+            }
+        }
+
+        // one task per thread
+        auto kernel = [&](std::size_t begin, std::size_t end) {
+            for (std::size_t thread = begin; thread < end; ++thread)
+            {
+                updateLevels(tasks[thread], sp::Execution::Sequential);
+            }
+        };
+
+        sp::details::parallelFor(nThreads, sp::Execution::Parallel, kernel, 1, 1);
+    }
+
+    // world = world(parent) * local for each node, the parents are up to date
+    void
+    updateLevel(const std::vector<Node> & nodes, sp::Execution execution)
+    {
+        T * worldCoeffs       = worlds[0].t.matrix().data();
+        const T * localCoeffs = locals[0].t.matrix().data();
+
+        auto kernel = [&](std::size_t begin, std::size_t end) {
+            std::size_t i = begin;
+            for (; i + Batch::size <= end; i += Batch::size)
+            {
+                alignas(IndexBatch::arch_type::alignment()) Index nodeOffsets[Batch::size];
+                alignas(IndexBatch::arch_type::alignment()) Index parentOffsets[Batch::size];
+                for (std::size_t l = 0; l < Batch::size; ++l)
+                {
+                    Node node        = nodes[i + l];
+                    nodeOffsets[l]   = static_cast<Index>(node * stride);
+                    parentOffsets[l] = static_cast<Index>(parents[node] * stride);
+                }
+
+                const IndexBatch nodeIndices   = IndexBatch::load_aligned(nodeOffsets);
+                const IndexBatch parentIndices = IndexBatch::load_aligned(parentOffsets);
+
+                AffineBatches p = gather(worldCoeffs, parentIndices);
+                AffineBatches l = gather(localCoeffs, nodeIndices);
+                scatter(multiply(p, l), worldCoeffs, nodeIndices);
+
+                for (std::size_t k = 0; k < Batch::size; ++k)
+                {
+                    Node node        = nodes[i + k];
+                    worlds[node].setClass(std::max(
+                        worlds[parents[node]].transformClass(),
+                        locals[node].transformClass()
+                    ));
+                }
+            }
+
+            for (; i < end; ++i)
+            {
+                Node node    = nodes[i];
+                worlds[node] = worlds[parents[node]] * locals[node];
+            }
+        };
+
+        sp::details::parallelFor(nodes.size(), execution, kernel, Batch::size, grainSize);
+    }
+
+    // affine part (the stored rows but the last constant one), column major
+    static AffineBatches
+    gather(const T * coeffs, const IndexBatch & indices)
+    {
+        AffineBatches m;
+        for (sp::Int32 c = 0; c < dim + 1; ++c)
+        {
+            for (sp::Int32 r = 0; r < dim; ++r)
+            {
+                m[c * dim + r] = Batch::gather(coeffs + c * nStoredRows + r, indices);
+            }
+        }
+
+        return m;
+    }
+
+    static void
+    scatter(const AffineBatches & m, T * coeffs, const IndexBatch & indices)
+    {
+        for (sp::Int32 c = 0; c < dim + 1; ++c)
+        {
+            for (sp::Int32 r = 0; r < dim; ++r)
+            {
+                m[c * dim + r].scatter(coeffs + c * nStoredRows + r, indices);
+            }
+        }
+    }
+
+    // product of affine transformations
+    static AffineBatches
+    multiply(const AffineBatches & a, const AffineBatches & b)
+    {
+        AffineBatches res;
+        for (sp::Int32 c = 0; c < dim + 1; ++c)
+        {
+            for (sp::Int32 r = 0; r < dim; ++r)
+            {
+                Batch sum = c == dim ? a[dim * dim + r] : Batch{T{0}};
+                for (sp::Int32 k = 0; k < dim; ++k)
+                {
+                    sum = xsimd::fma(a[k * dim + r], b[c * dim + k], sum);
+                }
+                res[c * dim + r] = sum;
+            }
+        }
+
+        return res;
+    }
+
+    std::vector<Trans> locals{};
+    std::vector<Trans> worlds{};
+    std::vector<Node> parents{};
+    std::vector<sp::Int32> depths{};
+
+    // nodes of each depth, in the order they were added
+    std::vector<std::vector<Node>> levels{};
+
+    std::vector<bool> dirty{};   // local changed since the last update
+    std::vector<bool> changed{}; // world recomputed by the current update
+
+    // scratch of update(), kept to reuse their allocations
+    std::vector<std::vector<Node>> outdated{}; // nodes to recompute of each depth
+    std::vector<Subtree> subtrees{};
+    std::vector<std::size_t> subtreeOf{}; // of each outdated node
+    std::vector<std::vector<std::vector<Node>>> tasks{}; // outdated of each thread
+};
+
+template <sp::Int32 dim>
+using TransformHierarchy = TransformationHierarchy<float, dim>;
+
+typedef TransformHierarchy<2> TransformHierarchy2D;
+typedef TransformHierarchy<3> TransformHierarchy3D;
+
+} // namespace sp
+
+
+#endif // SPIRIT_HIERARCHY_HPP
@@ -0,0 +1,321 @@
+////////////////////////////////////////////////////////////
+//
+// Spirit
+// Copyright (C) 2022 Matthieu Beauchamp-Boulay
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it freely,
+// subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+////////////////////////////////////////////////////////////
+
+
+#ifndef SPIRIT_TRS_HPP
+#define SPIRIT_TRS_HPP
+
+#include "SPIRIT/Base.hpp"
+#include "SPIRIT/Math/Batch/Batch.hpp"
+#include "SPIRIT/Math/Matrix/Matrix.hpp"
+#include "SPIRIT/Math/Parallel/Parallel.hpp"
+#include "SPIRIT/Math/Quaternion/Quaternion.hpp"
+#include "SPIRIT/Math/Transform/Transform.hpp"
+
+#include <span>
+
+
+namespace sp
+{
+
+////////////////////////////////////////////////////////////
+/// \brief 3D transformation stored as translation, rotation and scale
+///
+/// Points are scaled, then rotated, then translated:
+/// p' = translation + rotation * (scaling * p).
+///
+/// The rotation is a quaternion, composing two TRS transformations
+/// costs about a quarter of the product of two sp::Transform3D,
+/// which matters when composing many joints of a skeleton.
+///
+/// As with sp::Transformation, operations are applied in the order they are called
+/// and the last transformation is the leftmost in products.
+///
+/// \warning A non-uniform scaling followed by a rotation is a shear,
+///          which cannot be stored. Only uniform scalings can be applied
+///          after the other operations (see scale). For the same reason,
+///          a product is exact when the scaling of its left operand is uniform
+///          and an inverse when its scaling is uniform, otherwise the
+///          shear is dropped, as is usual for skeletal animation.
+////////////////////////////////////////////////////////////
+template <class T>
+class TRSTransformation
+{
+    typedef sp::Vector<T, 3> Vector;
+    typedef sp::Quaternion<T> Rotation;
+
+    typedef sp::details::Batch<T> Batch;
+
+public:
+
+    // identity
+    TRSTransformation() : t{T{0}, T{0}, T{0}}, r{}, s{T{1}, T{1}, T{1}} {}
+
+    TRSTransformation(
+        const Vector & translation,
+        const Rotation & rotation,
+        const Vector & scaling = Vector{T{1}, T{1}, T{1}}
+    )
+        : t{translation}, r{rotation}, s{scaling}
+    {
+    }
+
+
+    const Vector &
+    translation() const
+    {
+        return t;
+    }
+
+    const Rotation &
+    rotation() const
+    {
+        return r;
+    }
+
+    const Vector &
+    scaling() const
+    {
+        return s;
+    }
+
+    void
+    setTranslation(const Vector & translation)
+    {
+        t = translation;
+    }
+
+    // rotation is assumed to be a unit quaternion
+    void
+    setRotation(const Rotation & rotation)
+    {
+        r = rotation;
+    }
+
+    // scaling is applied before the rotation, it may be non-uniform
+    void
+    setScaling(const Vector & scaling)
+    {
+        s = scaling;
+    }
+
+
+    Transformation<T, 3>
+    toTransformation() const
+    {
+        typename Transformation<T, 3>::Transform res;
+        res.fromPositionOrientationScale(t.mat, r.q, s.mat);
+
+        TransformClass cls = TransformClass::Affine;
+        if ((s.mat.array() == T{1}).all())
+        {
+            cls = TransformClass::Isometry;
+        }
+        else if ((s.mat.array() == s[0]).all())
+        {
+            cls = TransformClass::UniformScale;
+        }
+
+        return {res, cls};
+    }
+
+    Matrix<T, 4, 4>
+    toMatrix() const
+    {
+        return toTransformation().toMatrix();
+    }
+
+
+    TRSTransformation &
+    translate(const Vector & offset)
+    {
+        t += offset;
+        return *this;
+    }
+
+    // rotation is assumed to be a unit quaternion
+    TRSTransformation &
+    rotate(const Rotation & rotation)
+    {
+        r = rotation * r;
+        t = rotation * t;
+        return *this;
+    }
+
+    // axis is assumed to be normalized
+    TRSTransformation &
+    rotate(T radians, const Vector & axis)
+    {
+        return rotate(Rotation{radians, axis});
+    }
+
+    TRSTransformation &
+    scale(T scale)
+    {
+        s *= scale;
+        t *= scale;
+        return *this;
+    }
+
+    TRSTransformation
+    inversed() const
+    {
+        Vector invScaling = Vector{s.mat.cwiseInverse()};
+        Rotation invRotation = r.conjugated();
+        return {
+            Vector{-invScaling.mat.cwiseProduct((invRotation * t).mat)},
+            invRotation,
+            invScaling};
+    }
+
+    TRSTransformation &
+    inverse()
+    {
+        return *this = inversed();
+    }
+
+    // other is applied after all current transformations
+    TRSTransformation &
+    transform(const TRSTransformation & other)
+    {
+        return *this = other * (*this);
+    }
+
+    // applies other, then this
+    TRSTransformation
+    operator*(const TRSTransformation & other) const
+    {
+        return {*this * other.t, r * other.r, Vector{s.mat.cwiseProduct(other.s.mat)}};
+    }
+
+    TRSTransformation &
+    operator*=(const TRSTransformation & other)
+    {
+        return *this = *this * other;
+    }
+
+    Vector
+    operator*(const Vector & point) const
+    {
+        return t + r * Vector{s.mat.cwiseProduct(point.mat)};
+    }
+
+    bool
+    operator==(const TRSTransformation & other) const
+    {
+        return t == other.t && r == other.r && s == other.s;
+    }
+
+    bool
+    operator!=(const TRSTransformation & other) const
+    {
+        return !(*this == other);
+    }
+
+    bool
+    isApprox(
+        const TRSTransformation & other,
+        T tolerance = Eigen::NumTraits<T>::dummy_precision()
+    ) const
+    {
+        return t.isApprox(other.t, tolerance) && r.isApprox(other.r, tolerance)
+               && s.isApprox(other.s, tolerance);
+    }
+
+
+    ////////////////////////////////////////////////////////////
+    // Bulk application
+    ////////////////////////////////////////////////////////////
+
+    // Transforms points into res, res may be points itself.
+    void
+    applyTo(
+        std::span<const Vector> points,
+        std::span<Vector> res,
+        sp::Execution execution = sp::Execution::Sequential
+    ) const
+    {
+        static_assert(
+            sizeof(Vector) == 3 * sizeof(T),
+            "Vectors must be tightly packed"
+        );
+        SPIRIT_ASSERT(points.size() == res.size())
+
+        const auto indices = sp::details::strideIndices<T, 3>();
+
+        const sp::details::QuaternionBatches<T> rotation{
+            Batch{r.x()},
+            Batch{r.y()},
+            Batch{r.z()},
+            Batch{r.w()}};
+
+        sp::details::VectorBatches<T> translation, scaling;
+        for (sp::Int32 k = 0; k < 3; ++k)
+        {
+            translation[k] = Batch{t[k]};
+            scaling[k]     = Batch{s[k]};
+        }
+
+        auto kernel = [&](std::size_t begin, std::size_t end) {
+            std::size_t i = begin;
+            for (; i + Batch::size <= end; i += Batch::size)
+            {
+                const T * src = &points[i][0];
+                T * dst       = &res[i][0];
+
+                sp::details::VectorBatches<T> v;
+                for (sp::Int32 k = 0; k < 3; ++k)
+                {
+                    v[k] = Batch::gather(src + k, indices) * scaling[k];
+                }
+
+                v = sp::details::rotateBatches<T>(rotation, v);
+                for (sp::Int32 k = 0; k < 3; ++k)
+                {
+                    (v[k] + translation[k]).scatter(dst + k, indices);
+                }
+            }
+
+            for (; i < end; ++i)
+            {
+                res[i] = *this * points[i];
+            }
+        };
+
+        sp::details::parallelFor(points.size(), execution, kernel, Batch::size);
+    }
+
+private:
+
+    Vector t;
+    Rotation r;
+    Vector s;
+};
+
+typedef TRSTransformation<float> TRSTransform;
+
+} // namespace sp
+
+
+#endif // SPIRIT_TRS_HPP
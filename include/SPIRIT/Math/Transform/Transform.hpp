@@ -28,8 +28,16 @@
 
 #include "SPIRIT/Base.hpp"
 #include "Eigen/Geometry"
+#include "SPIRIT/Math/Dispatch/Dispatch.hpp"
 #include "SPIRIT/Math/Matrix/Matrix.hpp"
+#include "SPIRIT/Math/Parallel/Parallel.hpp"
+#include "SPIRIT/Math/Quaternion/Quaternion.hpp"
+#include "SPIRIT/Math/Stream/Stream.hpp"
+
+#include <algorithm>
+#include <array>
 #include <numbers>
+#include <span>
 
 
 namespace sp
@@ -53,6 +61,23 @@ degrees(T radians)
 // TODO: Static constructors (or derived classes specializing transforms),
 //      transform around.
 
+////////////////////////////////////////////////////////////
+/// \brief Kind of the linear part of a transformation
+///
+/// Tracked as operations are applied, so inverses and normals
+/// can take the cheapest path. Ordered from the most specific,
+/// a product is of the least specific kind of its operands.
+///
+/// Only transformations with TransformStorage::Affine track it,
+/// in the last row of their matrix. Compact ones are always Affine.
+////////////////////////////////////////////////////////////
+enum class TransformClass : sp::Uint8
+{
+    Isometry,     // rotations (and translations) only
+    UniformScale, // rotations scaled uniformly
+    Affine        // anything else, or unknown (built from a matrix)
+};
+
 ////////////////////////////////////////////////////////////
 /// \brief Represent matrix transformations to vectors
 /// 
@@ -62,28 +87,51 @@ degrees(T radians)
 /// sp::Transformation<float, 2> t{};
 /// t.translate({1, 2}).rotate(sp::radians(45.f)); // translate, then rotate(around the origin)
 /// \endcode
+///
+/// With TransformStorage::AffineCompact, the constant last row of the matrix
+/// is not stored (a 3x4 matrix in 3D) and products skip it.
+/// Both storages give the same results and convert to each other,
+/// but compact transformations do not track their TransformClass.
+/// The storage defaults to TransformStorage::Affine, see Matrix.hpp.
 ////////////////////////////////////////////////////////////
-template <class T, sp::Int32 dim>
+template <class T, sp::Int32 dim, TransformStorage storage>
 class Transformation
 {
     typedef Matrix<T, dim + 1, dim + 1> Mat;
 
+    constexpr static Eigen::TransformTraits mode
+        = storage == TransformStorage::Affine ? Eigen::Affine : Eigen::AffineCompact;
+
     typedef Eigen::Rotation2D<T> Rotation2D;
     typedef Eigen::AngleAxis<T> Rotation3D;
     typedef Eigen::Translation<T, dim> Translate;
 
-    typedef Eigen::Transform<T, dim, Eigen::Affine, Eigen::AutoAlign | Eigen::ColMajor>
+    typedef Eigen::Transform<T, dim, mode, Eigen::AutoAlign | Eigen::ColMajor>
         Transform;
 
+    typedef sp::Vector<T, dim> Vector;
+
 public:
 
-    Transformation() { t.setIdentity(); }
+    Transformation()
+    {
+        t.setIdentity();
+        setClass(TransformClass::Isometry);
+    }
 
     Transformation(const Transformation&) = default;
 
+    template <TransformStorage otherStorage>
+    Transformation(const Transformation<T, dim, otherStorage> & other)
+        : t{other.t}
+    {
+        setClass(other.transformClass());
+    }
+
     template <class U>
-    Transformation(const sp::Matrix<U, dim + 1, dim + 1> & mat) : t{mat}
+    Transformation(const sp::Matrix<U, dim + 1, dim + 1> & mat) : t{mat.mat}
     {
+        setClass(TransformClass::Affine);
     }
 
     template <class U>
@@ -93,11 +141,7 @@ public:
     }
 
     Transformation &
-    operator=(const Transformation & other)
-    {
-        t = other.t;
-        return *this;
-    }
+    operator=(const Transformation & other) = default;
 
     template <class U>
     Transformation &
@@ -105,6 +149,7 @@ public:
     {
         t.setIdentity();
         t.linear() = other.mat;
+        setClass(TransformClass::Affine);
         return *this;
     }
 
@@ -112,40 +157,83 @@ public:
     Transformation &
     operator=(const sp::Matrix<U, dim + 1, dim + 1> & other)
     {
-        t.matrix() = other;
+        t = Transform{other.mat};
+        setClass(TransformClass::Affine);
         return *this;
     }
 
 
+    TransformClass
+    transformClass() const
+    {
+        if constexpr (storage == TransformStorage::Affine)
+        {
+            return static_cast<TransformClass>(
+                affineCode - static_cast<sp::Uint8>(t.matrix()(dim, 0))
+            );
+        }
+        else
+        {
+            return TransformClass::Affine;
+        }
+    }
+
+    // The inverse of the linear part is its transpose for isometries,
+    // scaled by 1 / scale^2 for uniform scalings and a general inverse
+    // otherwise. The translation is then -linear^-1 * translation.
     Transformation
     inversed() const
     {
-        return t.inverse();
+        TransformClass cls = transformClass();
+        return Transformation{inverseOf(t, cls), cls};
     }
 
     Transformation &
     inverse()
     {
-        t = t.inverse();
+        TransformClass cls = transformClass();
+        t = inverseOf(t, cls);
+        setClass(cls);
         return *this;
     }
 
+    // Transforms normals (directions perpendicular to surfaces),
+    // the inverse transpose of linear().
+    // Normals keep their length if this is an isometry or a uniform scaling,
+    // otherwise they must be normalized after being transformed.
+    sp::Matrix<T, dim, dim>
+    normalMatrix() const
+    {
+        return sp::Matrix<T, dim, dim>{normalMatrixOf(t, transformClass())};
+    }
+
     Transformation &
     scale(T scale)
     {
         t.prescale(scale);
+        if (scale != T{1})
+        {
+            setClass(std::max(transformClass(), TransformClass::UniformScale));
+        }
+
         return *this;
     }
 
     Transformation &
-    scale(const sp::Vec<dim> & scales)
+    scale(const Vector & scales)
     {
-        t.prescale(scales);
+        if ((scales.mat.array() == scales[0]).all())
+        {
+            return scale(scales[0]);
+        }
+
+        t.prescale(scales.mat);
+        setClass(TransformClass::Affine);
         return *this;
     }
 
     Transformation &
-    translate(const sp::Vec<dim> & offset)
+    translate(const Vector & offset)
     {
         t.pretranslate(offset.mat);
         return *this;
@@ -153,26 +241,40 @@ public:
 
     Transformation &
     rotate(T radians)
+        requires(dim == 2)
     {
-        static_assert(dim == 2, "Must be a transformation in 2D");
         t.prerotate(Rotation2D{radians});
         return *this;
     }
 
-    // axis is assumed to be normalized
+    // axis is normalized so the rotation stays an isometry
+    Transformation &
+    rotate(T radians, const sp::Vector<T, 3> & axis)
+        requires(dim == 3)
+    {
+        t.prerotate(Rotation3D{radians, axis.mat.normalized()});
+        return *this;
+    }
+
+    // rotation is assumed to be a unit quaternion
     Transformation &
-    rotate(T radians, sp::Vec3 axis)
+    rotate(const sp::Quaternion<T> & rotation)
+        requires(dim == 3)
     {
-        static_assert(dim == 3, "Must be a transformation in 3D");
-        t.prerotate(Rotation3D{radians, axis.mat});
+        t.prerotate(rotation.q);
         return *this;
     }
 
     Transformation &
     shear(T sx, T sy)
+        requires(dim == 2)
     {
-        static_assert(dim == 2, "Must be a transformation in 2D");
-        t.preshear(sx, sy);
+        // Eigen's preshear does not compile (2x2 matrix built as a vector)
+        Eigen::Matrix<T, 2, 2> shearing;
+        shearing << 1, sx, sy, 1;
+        t.affine() = shearing * t.affine();
+
+        setClass(TransformClass::Affine);
         return *this;
     }
 
@@ -194,33 +296,43 @@ public:
         return sp::Matrix<T, dim, dim>{t.linear()};
     }
 
+    // the last row is [0 ... 0 1] with both storages
     Mat
     toMatrix() const
     {
-        return Mat{t.matrix()};
+        Mat res = Mat::Identity();
+        res.mat.template topRows<dim>() = t.affine();
+        return res;
     }
 
     // other is applied after all current transformations
-    template <class U>
+    template <class U, TransformStorage otherStorage>
     Transformation &
-    transform(const Transformation<U, dim> & other)
+    transform(const Transformation<U, dim, otherStorage> & other)
     {
-        return *this = other * (*this);
+        TransformClass cls = std::max(transformClass(), other.transformClass());
+        t = Transform{other.t * t};
+        setClass(cls);
+        return *this;
     }
 
 
-    template <class U>
+    template <class U, TransformStorage otherStorage>
     Transformation
-    operator*(const Transformation<U, dim> & other) const
+    operator*(const Transformation<U, dim, otherStorage> & other) const
     {
-        return t * other.t;
+        return Transformation{
+            Transform{t * other.t},
+            std::max(transformClass(), other.transformClass())};
     }
 
-    template <class U>
+    template <class U, TransformStorage otherStorage>
     Transformation &
-    operator*=(const Transformation<U, dim> & other)
+    operator*=(const Transformation<U, dim, otherStorage> & other)
     {
-        t = t * other.t; // TODO: Aliasing risk?
+        TransformClass cls = std::max(transformClass(), other.transformClass());
+        t = Transform{t * other.t}; // TODO: Aliasing risk?
+        setClass(cls);
         return *this;
     }
 
@@ -238,6 +350,73 @@ public:
         return *this * vectors;
     }
 
+    ////////////////////////////////////////////////////////////
+    // Bulk application
+    ////////////////////////////////////////////////////////////
+
+    // Transforms points into res, res may be points itself.
+    void
+    applyTo(
+        std::span<const Vector> points,
+        std::span<Vector> res,
+        sp::Execution execution = sp::Execution::Sequential
+    ) const
+    {
+        applyToSpan<true>(t, points, res, execution);
+    }
+
+    // Transforms directions (ignores the translation) into res,
+    // res may be directions itself.
+    void
+    applyLinearTo(
+        std::span<const Vector> directions,
+        std::span<Vector> res,
+        sp::Execution execution = sp::Execution::Sequential
+    ) const
+    {
+        applyToSpan<false>(t, directions, res, execution);
+    }
+
+    // Transforms normals with normalMatrix() into res, res may be normals itself.
+    void
+    applyNormalTo(
+        std::span<const Vector> normals,
+        std::span<Vector> res,
+        sp::Execution execution = sp::Execution::Sequential
+    ) const
+    {
+        applyToSpan<false>(normalTransform(), normals, res, execution);
+    }
+
+    sp::VecStream<T, dim>
+    applyTo(
+        const sp::VecStream<T, dim> & points,
+        sp::Execution execution = sp::Execution::Sequential
+    ) const
+    {
+        return applyToStream<true>(t, points, execution);
+    }
+
+    // ignores the translation
+    sp::VecStream<T, dim>
+    applyLinearTo(
+        const sp::VecStream<T, dim> & directions,
+        sp::Execution execution = sp::Execution::Sequential
+    ) const
+    {
+        return applyToStream<false>(t, directions, execution);
+    }
+
+    // Transforms normals with normalMatrix()
+    sp::VecStream<T, dim>
+    applyNormalTo(
+        const sp::VecStream<T, dim> & normals,
+        sp::Execution execution = sp::Execution::Sequential
+    ) const
+    {
+        return applyToStream<false>(normalTransform(), normals, execution);
+    }
+
     template <class U, sp::Int32 nCols>
     sp::Matrix<U, dim, nCols>
     operator*(const sp::Matrix<U, dim, nCols> & other) const
@@ -255,13 +434,13 @@ public:
     bool
     operator==(const Transformation & other) const
     {
-        return t.matrix() == other.t.matrix();
+        return t.affine() == other.t.affine();
     }
 
     bool
     operator!=(const Transformation & other) const
     {
-        return t.matrix() != other.t.matrix();
+        return t.affine() != other.t.affine();
     }
 
     bool
@@ -270,16 +449,184 @@ public:
         T tolerance = Eigen::NumTraits<T>::dummy_precision()
     ) const
     {
-        return t.isApprox(other.t, tolerance);
+        return t.affine().isApprox(other.t.affine(), tolerance);
     }
 
 
 private:
 
-    template <class, sp::Int32>
+    template <class, sp::Int32, TransformStorage>
     friend class Transformation;
 
-    Transformation(Transform t) : t{t} {}
+    template <class>
+    friend class TRSTransformation;
+
+    // updates world transformations a SIMD batch at a time
+    template <class, sp::Int32, TransformStorage>
+    friend class TransformationHierarchy;
+
+    Transformation(Transform t, TransformClass cls = TransformClass::Affine) : t{t}
+    {
+        setClass(cls);
+    }
+
+    // TransformClass::Affine stored as 0, which is what Eigen leaves in
+    // the last row of the transformations it computes (makeAffine()).
+    // Eigen::Affine products and inverses never read that row.
+    constexpr static sp::Uint8 affineCode
+        = static_cast<sp::Uint8>(TransformClass::Affine);
+
+    void
+    setClass(TransformClass cls)
+    {
+        if constexpr (storage == TransformStorage::Affine)
+        {
+            t.matrix()(dim, 0) = static_cast<T>(affineCode - static_cast<sp::Uint8>(cls));
+        }
+    }
+
+    static Transform
+    inverseOf(const Transform & t, TransformClass cls)
+    {
+        switch (cls)
+        {
+        case TransformClass::Isometry:
+            return t.inverse(Eigen::Isometry);
+
+        case TransformClass::UniformScale:
+        {
+            // linear = s * R, so linear^-1 = R^T / s = linear^T / s^2
+            Transform inv;
+            inv.linear() = t.linear().transpose() / t.linear().col(0).squaredNorm();
+            inv.translation() = -inv.linear() * t.translation();
+            inv.makeAffine();
+            return inv;
+        }
+
+        default:
+            return t.inverse(Eigen::Affine);
+        }
+    }
+
+    static Eigen::Matrix<T, dim, dim>
+    normalMatrixOf(const Transform & t, TransformClass cls)
+    {
+        switch (cls)
+        {
+        case TransformClass::Isometry:
+            return t.linear();
+
+        // (R^T / s)^T = R = linear / s, keeps lengths
+        case TransformClass::UniformScale:
+            return t.linear() / t.linear().col(0).norm();
+
+        default:
+            return t.linear().inverse().transpose();
+        }
+    }
+
+    // linear part is normalMatrix(), no translation
+    Transform
+    normalTransform() const
+    {
+        Transform n;
+        n.linear() = normalMatrixOf(t, transformClass());
+        n.translation().setZero();
+        n.makeAffine();
+        return n;
+    }
+
+    // coefficients of the affine part of tr, column major
+    static sp::details::AffineCoeffs<T, dim>
+    affineCoeffs(const Transform & tr)
+    {
+        sp::details::AffineCoeffs<T, dim> m;
+        for (sp::Int32 c = 0; c < dim + 1; ++c)
+        {
+            for (sp::Int32 r = 0; r < dim; ++r)
+            {
+                m[c * dim + r] = tr.matrix()(r, c);
+            }
+        }
+
+        return m;
+    }
+
+    template <bool isPoint>
+    static void
+    applyToSpan(
+        const Transform & tr,
+        std::span<const Vector> vectors,
+        std::span<Vector> res,
+        sp::Execution execution
+    )
+    {
+        static_assert(
+            sizeof(Vector) == dim * sizeof(T),
+            "Vectors must be tightly packed"
+        );
+        SPIRIT_ASSERT(vectors.size() == res.size())
+
+        const sp::details::AffineCoeffs<T, dim> m = affineCoeffs(tr);
+        const T * src = reinterpret_cast<const T *>(vectors.data());
+        T * dst       = reinterpret_cast<T *>(res.data());
+
+        auto kernel = [&](std::size_t begin, std::size_t end) {
+            sp::details::dispatchTransformPacked<T, dim>(
+                m.data(),
+                src + begin * dim,
+                dst + begin * dim,
+                end - begin,
+                isPoint
+            );
+        };
+
+        sp::details::parallelFor(
+            vectors.size(),
+            execution,
+            kernel,
+            sp::details::Batch<T>::size
+        );
+    }
+
+    template <bool isPoint>
+    static sp::VecStream<T, dim>
+    applyToStream(
+        const Transform & tr,
+        const sp::VecStream<T, dim> & vectors,
+        sp::Execution execution
+    )
+    {
+        sp::VecStream<T, dim> res(vectors.size());
+
+        const sp::details::AffineCoeffs<T, dim> m = affineCoeffs(tr);
+
+        auto kernel = [&](std::size_t begin, std::size_t end) {
+            std::array<const T *, dim> src;
+            std::array<T *, dim> dst;
+            for (sp::Int32 k = 0; k < dim; ++k)
+            {
+                src[k] = vectors.lane(k) + begin;
+                dst[k] = res.lane(k) + begin;
+            }
+
+            sp::details::dispatchTransformSplit<T, dim>(
+                m.data(),
+                src.data(),
+                dst.data(),
+                end - begin,
+                isPoint
+            );
+        };
+
+        sp::details::parallelFor(
+            vectors.size(),
+            execution,
+            kernel,
+            sp::details::Batch<T>::size
+        );
+        return res;
+    }
 
     Transform t;
 };
@@ -287,9 +634,30 @@ private:
 template <sp::Int32 dim>
 using Transform = Transformation<float, dim>;
 
+template <sp::Int32 dim>
+using CompactTransform = Transformation<float, dim, TransformStorage::AffineCompact>;
+
 typedef Transform<2> Transform2D;
 typedef Transform<3> Transform3D;
 
+typedef CompactTransform<2> CompactTransform2D;
+typedef CompactTransform<3> CompactTransform3D;
+
+
+////////////////////////////////////////////////////////////
+// Common types are compiled once, in spirit-math (src/SPIRIT/Instantiation)
+////////////////////////////////////////////////////////////
+
+extern template class Transformation<float, 2>;
+extern template class Transformation<float, 3>;
+extern template class Transformation<float, 2, TransformStorage::AffineCompact>;
+extern template class Transformation<float, 3, TransformStorage::AffineCompact>;
+
+extern template class Transformation<double, 2>;
+extern template class Transformation<double, 3>;
+extern template class Transformation<double, 2, TransformStorage::AffineCompact>;
+extern template class Transformation<double, 3, TransformStorage::AffineCompact>;
+
 } // namespace sp
 
 
@@ -0,0 +1,130 @@
+////////////////////////////////////////////////////////////
+//
+// Spirit
+// Copyright (C) 2022 Matthieu Beauchamp-Boulay
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it freely,
+// subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+////////////////////////////////////////////////////////////
+
+#include "SPIRIT/Math/Dispatch/Dispatch.hpp"
+
+#include <cstdlib>
+#include <cstring>
+
+namespace sp
+{
+
+namespace details
+{
+
+#ifdef SPIRIT_MATH_RUNTIME_DISPATCH
+
+namespace
+{
+
+bool
+isSupported(SimdArch arch)
+{
+    const auto & available = xsimd::available_architectures();
+
+    switch (arch)
+    {
+        case SimdArch::Sse2: return available.sse2;
+        case SimdArch::Avx2: return available.avx2 && available.fma3_avx2;
+        case SimdArch::Avx512: return available.avx512f;
+        default: return false;
+    }
+}
+
+SimdArch
+selectArch()
+{
+    // best first
+    constexpr SimdArch candidates[] = {SimdArch::Avx512, SimdArch::Avx2, SimdArch::Sse2};
+
+    if (const char * requested = std::getenv("SPIRIT_MATH_ARCH"))
+    {
+        for (SimdArch arch : candidates)
+        {
+            if (std::strcmp(requested, getSimdArchName(arch)) == 0 && isSupported(arch))
+            {
+                return arch;
+            }
+        }
+    }
+
+    for (SimdArch arch : candidates)
+    {
+        if (isSupported(arch))
+        {
+            return arch;
+        }
+    }
+
+    // sse2 is part of x86-64
+    return SimdArch::Sse2;
+}
+
+} // namespace
+
+
+const Kernels &
+dispatchedKernels()
+{
+    static const Kernels & kernels = []() -> const Kernels & {
+        switch (getSimdArch())
+        {
+            case SimdArch::Avx512: return archKernels<xsimd::avx512f>();
+            case SimdArch::Avx2: return archKernels<xsimd::fma3<xsimd::avx2>>();
+            default: return archKernels<xsimd::sse2>();
+        }
+    }();
+
+    return kernels;
+}
+
+#endif
+
+} // namespace details
+
+
+SimdArch
+getSimdArch()
+{
+#ifdef SPIRIT_MATH_RUNTIME_DISPATCH
+    static const SimdArch arch = details::selectArch();
+    return arch;
+#else
+    return SimdArch::Native;
+#endif
+}
+
+const char *
+getSimdArchName(SimdArch arch)
+{
+    switch (arch)
+    {
+        case SimdArch::Sse2: return "sse2";
+        case SimdArch::Avx2: return "avx2";
+        case SimdArch::Avx512: return "avx512";
+        default: return "native";
+    }
+}
+
+} // namespace sp
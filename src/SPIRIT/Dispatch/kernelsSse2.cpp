@@ -22,18 +22,24 @@
 //
 ////////////////////////////////////////////////////////////
 
-#include "SPIRIT/Base.hpp"
+#include "SPIRIT/Math/Dispatch/Dispatch.hpp"
+
+// Compiled with the flags enabling xsimd::sse2, see CMakeLists.txt
 
 namespace sp
 {
 
-void foo(){
-    sp::spiritLog() << sp::Info{"Foo"};
-}
-
-
-
+namespace details
+{
 
-} // namepace sp 
+template <>
+const Kernels &
+archKernels<xsimd::sse2>()
+{
+    static const Kernels kernels = makeKernels<xsimd::sse2>();
+    return kernels;
+}
 
+} // namespace details
 
+} // namespace sp
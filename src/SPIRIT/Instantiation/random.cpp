@@ -0,0 +1,67 @@
+////////////////////////////////////////////////////////////
+//
+// Spirit
+// Copyright (C) 2022 Matthieu Beauchamp-Boulay
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it freely,
+// subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+////////////////////////////////////////////////////////////
+
+#include "SPIRIT/Math/Random/Bulk.hpp"
+#include "SPIRIT/Math/Random/Philox.hpp"
+#include "SPIRIT/Math/Random/Ziggurat.hpp"
+
+
+namespace sp
+{
+
+// Definitions of the extern templates of Philox.hpp, Bulk.hpp and Ziggurat.hpp
+
+template std::array<sp::Uint32, 4>
+Philox::generate<sp::Uint32>(std::array<sp::Uint32, 4> ctr, std::array<sp::Uint32, 2> k);
+
+namespace details
+{
+
+template sp::Uint32
+boundedWord(sp::Philox & engine, sp::Uint32 range, sp::Uint32 threshold);
+
+template double
+unitDouble(sp::Philox & engine);
+
+template class Ziggurat<float>;
+template class Ziggurat<double>;
+
+template float
+Ziggurat<float>::operator()(sp::Philox & engine) const;
+template double
+Ziggurat<double>::operator()(sp::Philox & engine) const;
+
+template bool
+Ziggurat<float>::tryWord(sp::Philox & engine, Word word, float & res) const;
+template bool
+Ziggurat<double>::tryWord(sp::Philox & engine, Word word, double & res) const;
+
+template float
+Ziggurat<float>::tail(sp::Philox & engine, bool negative);
+template double
+Ziggurat<double>::tail(sp::Philox & engine, bool negative);
+
+} // namespace details
+
+} // namespace sp
@@ -0,0 +1,96 @@
+"""
+Runtime dispatch isolation check.
+
+The units of src/SPIRIT/Dispatch are compiled with -mavx2 / -mavx512f.
+Any inline function or template instantiation they emit with external
+linkage may also be emitted by the baseline units, and the linker keeps
+only one of the copies. If it keeps the AVX-512 one, baseline code
+executes AVX-512 instructions on any CPU.
+
+Fails when one of these units, in the static library, defines a global
+symbol whose name does not involve its own instruction set.
+
+usage:
+    checkDispatch.py [--nm NM] library units...
+"""
+
+import argparse
+import re
+import subprocess
+import sys
+
+
+# xsimd architecture each unit is compiled for, as it appears in
+# the demangled names of the code instantiated for it
+UNIT_ARCHS = {
+    "kernelsSse2": "xsimd::sse2",
+    "kernelsAvx2": "xsimd::fma3<xsimd::avx2>",
+    "kernelsAvx512": "xsimd::avx512f",
+}
+
+# global code and data the linker merges or resolves across units
+GLOBAL_TYPES = {"T", "W", "V", "u"}
+
+MEMBER = re.compile(r"^(\S+):$")
+SYMBOL = re.compile(r"^[0-9a-f]+ (\S) (.*)$")
+
+
+def sharedSymbols(nm, library, units):
+    output = subprocess.run(
+        [nm, "--defined-only", "--demangle", library],
+        check=True,
+        capture_output=True,
+        text=True,
+    ).stdout
+
+    found = []
+    unit = None
+    for line in output.splitlines():
+        match = MEMBER.match(line)
+        if match:
+            # kernelsAvx2.cpp.o, kernelsAvx2.o, ...
+            member = match.group(1).split(".")[0]
+            unit = member if member in units else None
+            continue
+
+        match = SYMBOL.match(line)
+        if unit is None or match is None:
+            continue
+
+        symbolType, name = match.groups()
+        if symbolType in GLOBAL_TYPES and UNIT_ARCHS[unit] not in name:
+            found.append((unit, name))
+
+    return found
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter
+    )
+    parser.add_argument("--nm", default="nm")
+    parser.add_argument("library")
+    parser.add_argument("units", nargs="+")
+    args = parser.parse_args()
+
+    unknown = set(args.units) - UNIT_ARCHS.keys()
+    if unknown:
+        parser.error(f"no architecture known for {', '.join(sorted(unknown))}")
+
+    found = sharedSymbols(args.nm, args.library, set(args.units))
+    for unit, name in found:
+        print(f"{unit}: {name}")
+
+    if found:
+        print(
+            f"{len(found)} symbols may be shared with the baseline code, "
+            "see include/SPIRIT/Math/Dispatch/Dispatch.hpp"
+        )
+        return 1
+
+    print(f"{', '.join(args.units)} only define their own symbols")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,96 @@
+#include "SPIRIT/Math/Batch/Batch.hpp"
+#include "catch2/catch_test_macros.hpp"
+
+#include <cmath>
+
+
+TEST_CASE("Batch")
+{
+    typedef sp::BatchF Floats;
+    constexpr std::size_t n = Floats::size;
+
+    alignas(Floats::alignment) float values[n];
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        values[i] = static_cast<float>(i) - 1.5f;
+    }
+
+    Floats x = Floats::loadAligned(values);
+
+    SECTION("Loads, stores and lanes")
+    {
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            REQUIRE(x[i] == values[i]);
+        }
+
+        float unaligned[n + 1];
+        (x + 1).storeUnaligned(unaligned + 1);
+        REQUIRE(Floats::loadUnaligned(unaligned + 1)[0] == values[0] + 1);
+
+        Floats::Indices reversed;
+        alignas(Floats::alignment) sp::Int32 indices[n];
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            indices[i] = static_cast<sp::Int32>(n - 1 - i);
+        }
+        reversed = Floats::Indices::loadAligned(indices);
+
+        Floats gathered = Floats::gather(values, reversed);
+        REQUIRE(gathered[0] == values[n - 1]);
+
+        float scattered[n];
+        gathered.scatter(scattered, reversed);
+        REQUIRE(Floats::loadUnaligned(scattered)[1] == values[1]);
+
+        REQUIRE(x.cast<sp::Int32>()[0] == -1);
+        REQUIRE(Floats{1}.bitCast<sp::Int32>()[0] == 0x3F800000);
+    }
+
+    SECTION("Arithmetic, masks and reductions")
+    {
+        Floats y = x * 2 - 1;
+        REQUIRE(y[0] == values[0] * 2 - 1);
+        REQUIRE((y / 2)[1] == (values[1] * 2 - 1) / 2);
+        REQUIRE((-x)[0] == 1.5f);
+        REQUIRE(sp::fma(x, x, x)[2] == values[2] * values[2] + values[2]);
+
+        Floats::Mask positive = x > 0;
+        REQUIRE(!positive[0]);
+        REQUIRE(positive[n - 1]);
+        REQUIRE(positive.any());
+        REQUIRE(!positive.all());
+        REQUIRE((positive | !positive).all());
+        REQUIRE((positive & !positive).none());
+        REQUIRE(sp::BatchMask<float>::fromBits(positive.bits()).bits() == positive.bits());
+
+        Floats clamped = sp::select(positive, x, Floats{0});
+        REQUIRE(clamped.minCoeff() == 0);
+        REQUIRE(clamped.maxCoeff() == values[n - 1]);
+        REQUIRE(sp::max(x, Floats{0}).sum() == clamped.sum());
+        REQUIRE(sp::abs(x)[0] == 1.5f);
+
+        sp::BatchI ints{6};
+        REQUIRE(((ints << 2) | sp::BatchI{1})[0] == 25);
+        REQUIRE((ints >> 1)[0] == 3);
+    }
+
+    SECTION("Math functions")
+    {
+        Floats a = sp::abs(x) + 0.25f;
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            float v = a[i];
+            REQUIRE(std::abs(sp::sqrt(a)[i] - std::sqrt(v)) < 1e-5f);
+            REQUIRE(std::abs(sp::rsqrt(a)[i] - 1 / std::sqrt(v)) < 1e-5f);
+            REQUIRE(std::abs(sp::sin(a)[i] - std::sin(v)) < 1e-5f);
+            REQUIRE(std::abs(sp::cos(a)[i] - std::cos(v)) < 1e-5f);
+            REQUIRE(std::abs(sp::exp(a)[i] - std::exp(v)) < 1e-4f * std::exp(v));
+            REQUIRE(std::abs(sp::log(a)[i] - std::log(v)) < 1e-5f);
+        }
+
+        REQUIRE(sp::round(Floats{2.5f})[0] == 3);
+        REQUIRE(sp::floor(Floats{-0.5f})[0] == -1);
+        REQUIRE(sp::ceil(Floats{-0.5f})[0] == 0);
+    }
+}
@@ -52,6 +52,123 @@ TEST_CASE("Matrix")
         );
     }
 
+    SECTION("Lazy expressions")
+    {
+        sp::Mat3 a = sp::Mat3::Random();
+        sp::Mat3 b = sp::Mat3::Random();
+        sp::Mat3 c = sp::Mat3::Random();
+
+        sp::Mat3 eager = a * 2 + b * 3 - c / 2;
+        sp::Mat3 res   = sp::lazy(a) * 2 + sp::lazy(b) * 3 - sp::lazy(c) / 2;
+        REQUIRE(res.isApprox(eager));
+
+        res = sp::lazy(a) * b * c;
+        REQUIRE(res.isApprox(a * b * c));
+        REQUIRE((-(sp::lazy(a) + b)).eval() == -1 * (a + b));
+        REQUIRE(sp::lazy(a).transposed().eval() == a.transposed());
+
+        // the destination is read by the expression
+        sp::Mat3 expected = a * b;
+        sp::Mat3 aliased  = a;
+        aliased           = sp::lazy(aliased) * b;
+        REQUIRE(aliased.isApprox(expected));
+
+        aliased = b;
+        aliased = sp::lazy(aliased).transposed();
+        REQUIRE(aliased == b.transposed());
+
+        expected = a + a * b;
+        aliased  = a;
+        aliased += sp::lazy(aliased) * b;
+        REQUIRE(aliased.isApprox(expected));
+
+        sp::Vec3 v{1, 2, 3};
+        sp::Vec3 w = sp::lazy(a) * v - v;
+        REQUIRE(w.isApprox(a * v - v));
+    }
+
+    SECTION("Dynamic size")
+    {
+        sp::MatX a = sp::MatX::Random(70, 40);
+        sp::MatX b = sp::MatX::Random(40, 90);
+        REQUIRE(a.rows() == 70);
+        REQUIRE(a.cols() == 40);
+
+        sp::MatX product = a * b;
+        REQUIRE(product.rows() == 70);
+        REQUIRE(product.cols() == 90);
+
+        float expected = 0;
+        for (sp::Int32 k = 0; k < 40; ++k)
+        {
+            expected += a(3, k) * b(k, 5);
+        }
+        REQUIRE(std::abs(product(3, 5) - expected) < 1e-4f);
+
+        sp::MatX identity = sp::MatX::Identity(3, 3);
+        REQUIRE(identity * identity == identity);
+
+        sp::VecX v{1, 2, 3};
+        REQUIRE(v.size() == 3);
+        REQUIRE((identity * v) == v);
+        REQUIRE(v.dot(v) == 14);
+
+        sp::MatX moved = std::move(product);
+        REQUIRE(moved.rows() == 70);
+        REQUIRE(product.size() == 0);
+
+        moved.resize(2, 2);
+        REQUIRE(moved.size() == 4);
+
+        sp::MatX zeros(5, 5);
+        zeros = sp::MatX::Zero(5, 5);
+        REQUIRE(zeros.isApprox(sp::MatX::Zero(5, 5)));
+
+        sp::setNbThreads(1);
+        REQUIRE(sp::getNbThreads() >= 1);
+    }
+
+    SECTION("Decompositions")
+    {
+        sp::Mat3 m{
+            {4, 1, 0},
+            {1, 3, 1},
+            {0, 1, 2}
+        };
+        sp::Vec3 b{1, 2, 3};
+        sp::Vec3 x = m.solve(b);
+
+        sp::QR<float, 3, 3> qr{m};
+        sp::AccurateQR<float, 3, 3> accurateQr{m};
+        sp::LU<float, 3> lu{m};
+        sp::LDLT<float, 3> ldlt{m};
+        sp::Cholesky<float, 3> cholesky{m};
+
+        REQUIRE(qr.solve(b).isApprox(x));
+        REQUIRE(accurateQr.solve(b).isApprox(x));
+        REQUIRE(lu.solve(b).isApprox(x));
+        REQUIRE(ldlt.solve(b).isApprox(x));
+        REQUIRE(cholesky.solve(b).isApprox(x));
+        REQUIRE(cholesky.isValid());
+
+        sp::Vec3 reused;
+        cholesky.solve(sp::Vec3{0, 1, 0}, reused);
+        REQUIRE(m.isGoodSolution(reused, sp::Vec3{0, 1, 0}));
+
+        // refactoring in place
+        m(2, 2) = 5;
+        cholesky.compute(m);
+        REQUIRE(cholesky.solve(b).isApprox(m.solve(b)));
+
+        sp::Cholesky<float, 3> notDefinite{-1 * sp::Mat3::Identity()};
+        REQUIRE(!notDefinite.isValid());
+
+        sp::MatX big = sp::MatX::Random(20, 20);
+        sp::LU<float, sp::Dynamic> bigLu{big};
+        sp::MatX rhs = sp::MatX::Random(20, 3);
+        REQUIRE((big * bigLu.solve(rhs)).isApprox(rhs, 1e-3f));
+    }
+
     SECTION("Matrix operations"){
         // add, mult, div, cross, dot, solver, ...
 
@@ -0,0 +1,120 @@
+#include "SPIRIT/Math/Quaternion/Quaternion.hpp"
+#include "SPIRIT/Math/Transform/Transform.hpp"
+#include "catch2/catch_test_macros.hpp"
+
+#include <cmath>
+#include <vector>
+
+
+TEST_CASE("Quaternions")
+{
+    SECTION("Rotations")
+    {
+        sp::Quat q{sp::radians(90.f), sp::Vec3{0, 0, 1}};
+        REQUIRE((q * sp::Vec3{1, 0, 0}).isApprox(sp::Vec3{0, 1, 0}));
+        REQUIRE(q.toMatrix().isApprox(
+            sp::Transform3D{}.rotate(sp::radians(90.f), sp::Vec3{0, 0, 1}).linear()
+        ));
+        REQUIRE(sp::Quat{q.toMatrix()}.isApprox(q));
+
+        // rightmost first
+        sp::Quat r{sp::radians(90.f), sp::Vec3{1, 0, 0}};
+        sp::Vec3 v{0, 1, 0};
+        REQUIRE(((q * r) * v).isApprox(q * (r * v)));
+        REQUIRE(((q * r) * v).isApprox(sp::Vec3{0, 0, 1}));
+
+        sp::Quat c = q;
+        c *= r;
+        REQUIRE(c.isApprox(q * r));
+
+        REQUIRE((q.conjugated() * q).isApprox(sp::Quat::Identity()));
+        REQUIRE((q.inversed() * q).isApprox(sp::Quat::Identity()));
+
+        sp::Quat between = sp::Quat::FromTwoVectors({1, 0, 0}, {0, 0, 2});
+        REQUIRE((between * sp::Vec3{1, 0, 0}).isApprox(sp::Vec3{0, 0, 1}));
+
+        sp::Quat scaled{2, 0, 0, 0};
+        REQUIRE(std::abs(scaled.normalized().norm() - 1) < 1e-6f);
+        scaled.normalize();
+        REQUIRE(scaled == sp::Quat::Identity());
+    }
+
+    SECTION("Interpolation")
+    {
+        sp::Quat a{};
+        sp::Quat b{sp::radians(90.f), sp::Vec3{0, 1, 0}};
+        sp::Quat half{sp::radians(45.f), sp::Vec3{0, 1, 0}};
+
+        REQUIRE(a.slerp(b, 0).isApprox(a));
+        REQUIRE(a.slerp(b, 1).isApprox(b));
+        REQUIRE(a.slerp(b, 0.5f).isApprox(half));
+
+        // symmetric, so the midpoint is the same
+        REQUIRE(a.nlerp(b, 0.5f).isApprox(half));
+        REQUIRE(std::abs(a.nlerp(b, 0.3f).norm() - 1) < 1e-6f);
+        REQUIRE(std::abs(a.angularDistance(b) - sp::radians(90.f)) < 1e-5f);
+
+        // -b is the same rotation, takes the shortest path
+        sp::Quat negB{-b.w(), -b.x(), -b.y(), -b.z()};
+        REQUIRE((a.nlerp(negB, 0.5f) * sp::Vec3{1, 0, 0}).isApprox(half * sp::Vec3{1, 0, 0}));
+    }
+
+    SECTION("Transformations")
+    {
+        sp::Quat q{sp::radians(30.f), sp::Vec3{0, 1, 0}};
+
+        sp::Transform3D t{};
+        t.translate({1, 2, 3}).rotate(q);
+
+        sp::Transform3D expected{};
+        expected.translate({1, 2, 3}).rotate(sp::radians(30.f), sp::Vec3{0, 1, 0});
+        REQUIRE(t.isApprox(expected));
+    }
+
+    SECTION("Bulk operations")
+    {
+        std::vector<sp::Quat> lhs{};
+        std::vector<sp::Quat> rhs{};
+        std::vector<sp::Vec3> vectors{};
+        for (int i = 0; i < 45; ++i)
+        {
+            sp::Vec3 axis = sp::Vec3{1, float(i), float(-i)} / std::sqrt(1.f + 2 * i * i);
+            lhs.push_back(sp::Quat{0.1f * i, axis});
+            rhs.push_back(sp::Quat{-0.05f * i, sp::Vec3{0, 0, 1}});
+            vectors.push_back(sp::Vec3{float(i), 1, 2});
+        }
+
+        std::vector<sp::Quat> products(lhs.size());
+        sp::Quat::multiply(lhs, rhs, products);
+        for (std::size_t i = 0; i < lhs.size(); ++i)
+        {
+            REQUIRE(products[i].isApprox(lhs[i] * rhs[i]));
+        }
+
+        std::vector<sp::Vec3> rotated(vectors.size());
+        sp::Quat::rotate(lhs, vectors, rotated);
+        for (std::size_t i = 0; i < vectors.size(); ++i)
+        {
+            REQUIRE(rotated[i].isApprox(lhs[i] * vectors[i]));
+        }
+
+        lhs[3].applyTo(vectors, rotated);
+        for (std::size_t i = 0; i < vectors.size(); ++i)
+        {
+            REQUIRE(rotated[i].isApprox(lhs[3] * vectors[i]));
+        }
+
+        std::vector<sp::Quat> unnormalized(45, sp::Quat{1, 2, 3, 4});
+        sp::Quat::normalize(unnormalized);
+        for (const sp::Quat & q : unnormalized)
+        {
+            REQUIRE(q.isApprox(sp::Quat{1, 2, 3, 4}.normalized()));
+        }
+
+        // in place and across threads
+        std::vector<sp::Quat> many(200000, lhs[5]);
+        sp::Quat::multiply(many, many, many, sp::Execution::Parallel);
+        REQUIRE(many.front().isApprox(lhs[5] * lhs[5]));
+        REQUIRE(many.back().isApprox(lhs[5] * lhs[5]));
+    }
+}
@@ -0,0 +1,757 @@
+#include "SPIRIT/Math/Random/Random.hpp"
+#include "SPIRIT/Math/Matrix/Matrix.hpp"
+#include "SPIRIT/Math/Quaternion/Quaternion.hpp"
+#include "catch2/catch_test_macros.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <list>
+#include <map>
+#include <numeric>
+#include <set>
+#include <string>
+#include <thread>
+
+
+TEST_CASE("Random")
+{
+    SECTION("Philox")
+    {
+        // Known answers from the Random123 test vectors
+        REQUIRE(
+            sp::Philox::generate({0, 0, 0, 0}, {0, 0})
+            == sp::Philox::Counter{0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8}
+        );
+        REQUIRE(
+            sp::Philox::generate(
+                {0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff},
+                {0xffffffff, 0xffffffff}
+            )
+            == sp::Philox::Counter{0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd}
+        );
+        REQUIRE(
+            sp::Philox::generate(
+                {0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344},
+                {0xa4093822, 0x299f31d0}
+            )
+            == sp::Philox::Counter{0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1}
+        );
+
+        sp::Philox a{42, 1};
+        sp::Philox b{42, 1};
+        sp::Philox other{42, 2};
+        REQUIRE(a() == b());
+        REQUIRE(a() != other());
+
+        for (int n = 0; n < 5; ++n)
+        {
+            sp::Philox skipped{42, 1};
+            skipped.discard(n);
+            sp::Philox stepped{42, 1};
+            for (int i = 0; i < n; ++i)
+            {
+                stepped();
+            }
+            REQUIRE(skipped == stepped);
+            REQUIRE(skipped() == stepped());
+        }
+    }
+
+    SECTION("Engines")
+    {
+        // Known answers from the reference implementations
+        sp::SplitMix64 splitMix{0};
+        REQUIRE(splitMix() == 0xE220A8397B1DCDAF);
+
+        sp::Xoshiro256 xoshiro{sp::Xoshiro256::State{1, 2, 3, 4}};
+        REQUIRE(xoshiro() == 11520);
+        REQUIRE(xoshiro() == 0);
+        REQUIRE(xoshiro() == 1509978240);
+
+        sp::Pcg64 pcg{42, 54};
+        REQUIRE(pcg() == 0x86B1DA1D72062B68);
+        REQUIRE(pcg() == 0x1304AA46C9853D39);
+        REQUIRE(pcg() == 0xA3670E9E0DD50358);
+
+        auto testJumps = []<class Engine>(Engine engine, sp::Uint64 jumpSize) {
+            // jumping and stepping commute
+            Engine jumped = engine;
+            jumped.jump();
+            jumped();
+
+            Engine stepped = engine;
+            stepped();
+            stepped.jump();
+            REQUIRE(jumped == stepped);
+
+            Engine longJumped = engine;
+            longJumped.longJump();
+            REQUIRE(longJumped != jumped);
+            REQUIRE(longJumped != engine);
+
+            // streams of a seed are disjoint
+            Engine other{1, 1};
+            REQUIRE(Engine{1, 0}() != other());
+
+            if (jumpSize != 0)
+            {
+                Engine discarded = engine;
+                discarded.discard(jumpSize);
+                engine.jump();
+                REQUIRE(discarded == engine);
+            }
+        };
+
+        testJumps(sp::SplitMix64{3}, sp::Uint64{1} << 32);
+        testJumps(sp::Xoshiro256{3}, 0);
+        testJumps(sp::Pcg64{3}, 0);
+
+        sp::Pcg64 skipped{1, 2};
+        skipped.discard(1000);
+        sp::Pcg64 stepped{1, 2};
+        for (int i = 0; i < 1000; ++i)
+        {
+            stepped();
+        }
+        REQUIRE(skipped == stepped);
+
+        // same stream as seeding then jumping
+        sp::Xoshiro256 streamed{5, 2};
+        sp::Xoshiro256 jumped{5};
+        jumped.jump();
+        jumped.jump();
+        REQUIRE(streamed == jumped);
+    }
+
+    SECTION("Engine policy")
+    {
+        typedef sp::BasicRandom<sp::Xoshiro256> Random;
+        typedef sp::BasicRandList<sp::Xoshiro256> RandList;
+
+        Random::seed(7, 1);
+        sp::Xoshiro256 copy = Random::engine();
+        REQUIRE(copy == sp::Xoshiro256{7, 1});
+
+        float f = Random::Uni::randFloat(2.f, 3.f);
+        REQUIRE((f >= 2 && f < 3));
+        REQUIRE(Random::engine() != copy);
+
+        std::vector<float> floats(1000);
+        RandList::Uni::randFloat(-1.f, 1.f, floats);
+        REQUIRE(std::all_of(floats.begin(), floats.end(), [](float x) {
+            return x >= -1 && x < 1;
+        }));
+
+        std::vector<double> gauss(1000);
+        RandList::Gauss::randFloat(0.0, 1.0, gauss);
+
+        std::vector<sp::Int32> ints(1000);
+        RandList::Uni::randInt(3, 5, ints);
+        REQUIRE(std::all_of(ints.begin(), ints.end(), [](int i) { return i >= 3 && i <= 5; }));
+
+        std::vector<sp::Uint32> weighted(100);
+        RandList::Weighted::randInt({0.0, 1.0}, weighted);
+        REQUIRE(std::all_of(weighted.begin(), weighted.end(), [](sp::Uint32 i) {
+            return i == 1;
+        }));
+
+        // the engines of sp::Random are untouched
+        sp::Random::seed(7, 1);
+        sp::Philox philox = sp::Random::engine();
+        RandList::random(floats);
+        REQUIRE(sp::Random::engine() == philox);
+
+        // reproducible for a given seed
+        Random::seed(9);
+        RandList::random(floats);
+        std::vector<float> again(floats.size());
+        Random::seed(9);
+        RandList::random(again);
+        REQUIRE(floats == again);
+    }
+
+    SECTION("Per thread streams")
+    {
+        auto draw = [](sp::Uint64 stream) {
+            sp::Random::seed(7, stream);
+            std::vector<float> values(16);
+            sp::RandList::random(values);
+            return values;
+        };
+
+        std::vector<float> first;
+        std::vector<float> second;
+        std::jthread{[&]() { first = draw(3); }}.join();
+        std::jthread{[&]() { second = draw(3); }}.join();
+        REQUIRE(first == second);
+        REQUIRE(draw(3) == first);
+        REQUIRE(draw(4) != first);
+
+        sp::Random::Engine copy = sp::Random::engine();
+        float f                 = sp::Random::random();
+        sp::Random::engine()    = copy;
+        REQUIRE(sp::Random::random() == f);
+    }
+
+    SECTION("Bulk generation")
+    {
+        // vectorized Philox blocks match the scalar ones
+        sp::Philox engine{5, 9};
+        alignas(64) sp::Uint32 words[2 * sp::details::wordBlockSize];
+        sp::details::fillWords(engine, words, 2 * sp::details::wordBlockSize);
+
+        constexpr std::size_t nLanes = sp::details::WordBatch::size;
+        for (std::size_t b = 0; b < 2 * nLanes; ++b)
+        {
+            sp::Philox::Counter ctr = sp::Philox{5, 9}.getCounter();
+            sp::Philox::increment(ctr, b);
+            sp::Philox::Counter block = sp::Philox::generate(ctr, engine.getKey());
+
+            std::size_t first = (b / nLanes) * sp::details::wordBlockSize + b % nLanes;
+            for (std::size_t w = 0; w < 4; ++w)
+            {
+                REQUIRE(words[first + w * nLanes] == block[w]);
+            }
+        }
+
+        std::vector<float> floats(10001);
+        sp::RandList::Uni::randFloat(-2.f, 3.f, floats);
+        double mean = 0;
+        for (float f : floats)
+        {
+            REQUIRE(f >= -2.f);
+            REQUIRE(f < 3.f);
+            mean += f / floats.size();
+        }
+        REQUIRE(std::abs(mean - 0.5) < 0.1);
+
+        std::vector<double> doubles(1003);
+        sp::RandList::random<double>(doubles);
+        for (double d : doubles)
+        {
+            REQUIRE(d >= 0);
+            REQUIRE(d < 1);
+        }
+
+        std::vector<sp::Int32> ints(10007);
+        sp::RandList::Uni::randInt(-3, 3, ints);
+        std::array<int, 7> counts{};
+        for (sp::Int32 i : ints)
+        {
+            REQUIRE(i >= -3);
+            REQUIRE(i <= 3);
+            ++counts[i + 3];
+        }
+        for (int c : counts)
+        {
+            REQUIRE(c > 1000);
+        }
+
+        std::vector<sp::Uint32> choices(1000);
+        sp::RandList::choose(5u, choices);
+        REQUIRE(*std::max_element(choices.begin(), choices.end()) == 4);
+
+        sp::Random::seed(11);
+        sp::RandList::random(floats);
+        std::vector<float> replay(floats.size());
+        sp::Random::seed(11);
+        sp::RandList::random(replay);
+        REQUIRE(replay == floats);
+    }
+
+    SECTION("Bounded integers")
+    {
+        // non power of two, power of two and single value ranges
+        for (sp::Uint64 range : {3ull, 8ull, 1ull, 1000003ull})
+        {
+            sp::Xoshiro256 engine{range};
+            std::vector<int> counts(std::min<sp::Uint64>(range, 16));
+            const int n = 16000;
+            for (int i = 0; i < n; ++i)
+            {
+                sp::Uint64 x = sp::details::boundedInt(engine, range);
+                REQUIRE(x < range);
+                if (x < counts.size())
+                {
+                    ++counts[x];
+                }
+            }
+
+            if (range <= 16)
+            {
+                for (int c : counts)
+                {
+                    REQUIRE(std::abs(c - n / static_cast<int>(range)) < n / 40);
+                }
+            }
+        }
+
+        // rejection keeps ranges just above 2^63 uniform: half of the
+        // values are in the lower half, not 2/3 as with a modulo
+        sp::Philox engine{3};
+        const sp::Uint64 range = (sp::Uint64{1} << 63) + (sp::Uint64{1} << 62);
+        int low = 0;
+        for (int i = 0; i < 10000; ++i)
+        {
+            low += sp::details::boundedInt(engine, range) < range / 2;
+        }
+        REQUIRE(std::abs(low - 5000) < 250);
+
+        // extremes of the integer types
+        bool seenMin = false;
+        bool seenMax = false;
+        for (int i = 0; i < 4000; ++i)
+        {
+            sp::Int8 c = sp::Random::Uni::randInt<sp::Int8>(-128, 127);
+            seenMin |= c == -128;
+            seenMax |= c == 127;
+            REQUIRE(sp::Random::Uni::randInt<sp::Int64>(-5, -5) == -5);
+            REQUIRE(sp::Random::choose<sp::Uint16>(2) < 2);
+        }
+        REQUIRE(seenMin);
+        REQUIRE(seenMax);
+
+        auto full = [] {
+            return sp::Random::Uni::randInt(
+                std::numeric_limits<sp::Int64>::min(),
+                std::numeric_limits<sp::Int64>::max()
+            );
+        };
+        REQUIRE(full() != full());
+
+        // bulk power of two ranges
+        std::vector<sp::Int32> ints(16001);
+        sp::RandList::Uni::randInt(-8, 7, ints);
+        std::array<int, 16> counts{};
+        for (sp::Int32 i : ints)
+        {
+            REQUIRE(i >= -8);
+            REQUIRE(i <= 7);
+            ++counts[i + 8];
+        }
+        for (int c : counts)
+        {
+            REQUIRE(std::abs(c - 1000) < 150);
+        }
+
+        std::vector<sp::Uint32> ones(100);
+        sp::RandList::choose(1u, ones);
+        REQUIRE(std::all_of(ones.begin(), ones.end(), [](sp::Uint32 u) { return u == 0; }));
+
+        std::list<sp::Uint64> list(1000);
+        sp::RandList::choose<sp::Uint64>(6, list);
+        REQUIRE(*std::max_element(list.begin(), list.end()) == 5);
+    }
+
+    SECTION("Runtime dispatch")
+    {
+#ifdef SPIRIT_MATH_RUNTIME_DISPATCH
+        REQUIRE(sp::getSimdArch() != sp::SimdArch::Native);
+#else
+        REQUIRE(sp::getSimdArch() == sp::SimdArch::Native);
+#endif
+        REQUIRE(sp::getSimdArchName(sp::SimdArch::Avx2) == std::string{"avx2"});
+
+        sp::details::Kernels kernels = sp::details::makeKernels<xsimd::default_arch>();
+        sp::Philox engine{3};
+
+        std::vector<float> floats(1001);
+        kernels.uniformFloat(engine, floats.data(), floats.size(), 1.f, 2.f);
+        REQUIRE(*std::min_element(floats.begin(), floats.end()) >= 1.f);
+        REQUIRE(*std::max_element(floats.begin(), floats.end()) < 2.f);
+
+        std::vector<sp::Int32> ints(1001);
+        kernels.uniformInt(engine, ints.data(), ints.size(), -1, 1);
+        REQUIRE(*std::min_element(ints.begin(), ints.end()) == -1);
+        REQUIRE(*std::max_element(ints.begin(), ints.end()) == 1);
+    }
+
+    SECTION("Gaussian sampling")
+    {
+        auto checkMoments = [](const auto & values, double mean, double stdDev) {
+            double m = 0;
+            for (auto v : values)
+            {
+                m += v;
+            }
+            m /= values.size();
+
+            double var = 0;
+            for (auto v : values)
+            {
+                var += (v - m) * (v - m);
+            }
+            var /= values.size();
+
+            REQUIRE(std::abs(m - mean) < 0.05 * stdDev);
+            REQUIRE(std::abs(std::sqrt(var) - stdDev) < 0.05 * stdDev);
+        };
+
+        std::vector<float> floats(100003);
+        sp::RandList::Gauss::randFloat(2.f, 3.f, floats);
+        checkMoments(floats, 2, 3);
+
+        // tail beyond the ziggurat base layer is still reached
+        std::vector<double> doubles(200000);
+        sp::RandList::Gauss::randFloat(0.0, 1.0, doubles);
+        checkMoments(doubles, 0, 1);
+        auto beyond = std::count_if(doubles.begin(), doubles.end(), [](double d) {
+            return std::abs(d) > 3.6541528853610088;
+        });
+        REQUIRE(beyond > 20);
+        REQUIRE(beyond < 150);
+
+        std::vector<sp::Int32> ints(100000);
+        sp::RandList::Gauss::randInt(-50, 10, ints);
+        checkMoments(ints, -50, 10);
+
+        std::list<float> list(20000);
+        sp::RandList::Gauss::randFloat(1.f, 0.5f, list);
+        checkMoments(list, 1, 0.5);
+
+        std::vector<double> scalars(20000);
+        for (double & d : scalars)
+        {
+            d = sp::Random::Gauss::randFloat<double>(-1, 2);
+        }
+        checkMoments(scalars, -1, 2);
+    }
+
+    SECTION("Weighted sampling")
+    {
+        sp::WeightedSampler<> sampler{1, 0, 3, 4};
+        REQUIRE(sampler.size() == 4);
+
+        std::vector<sp::Uint32> draws(80000);
+        sampler.sample(draws);
+
+        std::array<int, 4> counts{};
+        for (sp::Uint32 d : draws)
+        {
+            REQUIRE(d < 4);
+            ++counts[d];
+        }
+        REQUIRE(counts[1] == 0);
+        REQUIRE(std::abs(counts[0] - 10000) < 1000);
+        REQUIRE(std::abs(counts[2] - 30000) < 1000);
+        REQUIRE(std::abs(counts[3] - 40000) < 1000);
+
+        sampler.setWeight(1, 4);
+        sampler.setWeight(3, 0);
+        counts = {};
+        for (int i = 0; i < 8000; ++i)
+        {
+            ++counts[sampler()];
+        }
+        REQUIRE(counts[3] == 0);
+        REQUIRE(std::abs(counts[1] - 4000) < 400);
+
+        std::list<int> list(100);
+        sp::RandList::Weighted::randInt<int>({0.0, 1.0}, list);
+        REQUIRE(std::all_of(list.begin(), list.end(), [](int i) { return i == 1; }));
+    }
+
+    SECTION("Geometric sampling")
+    {
+        sp::Random::seed(3);
+
+        // uniform on the sphere: centered, E[z^2] = 1/3
+        std::vector<sp::Vec3> sphere(100000);
+        sp::RandList::onSphere(sphere);
+        sp::Vec3 mean{0, 0, 0};
+        double zz = 0;
+        for (const sp::Vec3 & p : sphere)
+        {
+            REQUIRE(std::abs(p.norm() - 1) < 1e-5);
+            mean += p;
+            zz += p[2] * p[2];
+        }
+        REQUIRE(mean.norm() / sphere.size() < 0.01);
+        REQUIRE(std::abs(zz / sphere.size() - 1. / 3) < 0.005);
+
+        // uniform in the ball: the cubed radius is uniform
+        std::vector<sp::Vector<double, 3>> ball(100000);
+        sp::RandList::inBall(ball);
+        double cubed = 0;
+        for (const auto & p : ball)
+        {
+            REQUIRE(p.norm() <= 1);
+            cubed += std::pow(p.norm(), 3);
+        }
+        REQUIRE(std::abs(cubed / ball.size() - 0.5) < 0.005);
+
+        // uniform in the disk: the squared radius is uniform,
+        // a quarter of the points in each quadrant
+        std::list<sp::Vec2> disk(40000);
+        sp::RandList::inDisk(disk);
+        double squared = 0;
+        std::array<int, 4> quadrants{};
+        for (const sp::Vec2 & p : disk)
+        {
+            REQUIRE(p.norm() <= 1);
+            squared += p.squaredNorm();
+            ++quadrants[(p[0] < 0) + 2 * (p[1] < 0)];
+        }
+        REQUIRE(std::abs(squared / disk.size() - 0.5) < 0.01);
+        for (int count : quadrants)
+        {
+            REQUIRE(std::abs(count - 10000) < 400);
+        }
+
+        // cosine-weighted: E[z] = 2/3
+        std::vector<sp::Vec3> hemisphere(100000);
+        sp::RandList::cosineHemisphere(hemisphere);
+        double z = 0;
+        for (const sp::Vec3 & p : hemisphere)
+        {
+            REQUIRE(std::abs(p.norm() - 1) < 1e-5);
+            REQUIRE(p[2] >= 0);
+            z += p[2];
+        }
+        REQUIRE(std::abs(z / hemisphere.size() - 2. / 3) < 0.005);
+
+        // uniform rotations: unit quaternions, E[w^2] = 1/4,
+        // and a rotated axis is uniform on the sphere
+        std::vector<sp::Quat> rotations(50000);
+        sp::RandList::rotation(rotations);
+        double ww = 0;
+        sp::Vec3 axis{0, 0, 0};
+        for (const sp::Quat & q : rotations)
+        {
+            REQUIRE(std::abs(q.norm() - 1) < 1e-5);
+            ww += q.w() * q.w();
+            axis += q * sp::Vec3{0, 0, 1};
+        }
+        REQUIRE(std::abs(ww / rotations.size() - 0.25) < 0.005);
+        REQUIRE(axis.norm() / rotations.size() < 0.015);
+
+        // odd sizes end with a partial batch, reproducible from the seed
+        std::vector<sp::QuatD> first(37), second(37);
+        sp::Random::seed(11);
+        sp::RandList::rotation(first);
+        sp::Random::seed(11);
+        sp::RandList::rotation(second.begin(), second.end());
+        for (std::size_t i = 0; i < first.size(); ++i)
+        {
+            REQUIRE(first[i].isApprox(second[i]));
+        }
+    }
+
+    SECTION("Shuffle")
+    {
+        // every permutation is equally likely, with the paired draws of a single
+        // block, and with merges of small blocks of equal sizes or not
+        struct Case
+        {
+            std::size_t n;
+            std::size_t blockSize;
+            bool insideOut;
+        };
+
+        for (Case c : {Case{4, 2, false}, Case{5, 2, false}, Case{5, 8, false},
+                       Case{5, 2, true}, Case{5, 8, true}})
+        {
+            std::map<std::vector<int>, int> counts;
+            const int nTrials = 24000;
+            sp::Philox engine{c.n, c.blockSize};
+            for (int t = 0; t < nTrials; ++t)
+            {
+                std::vector<int> values(c.n);
+                std::iota(values.begin(), values.end(), 0);
+                sp::details::mergeShuffle(
+                    engine,
+                    values.begin(),
+                    values.end(),
+                    sp::Execution::Sequential,
+                    [&](sp::Philox & e, auto first, auto last) {
+                        if (c.insideOut)
+                        {
+                            sp::details::insideOut(e, first, last, first - values.begin());
+                        }
+                        else
+                        {
+                            sp::details::fisherYates(e, first, last);
+                        }
+                    },
+                    c.blockSize
+                );
+                ++counts[values];
+            }
+
+            // chi-squared statistic, within 5 deviations of its mean
+            const std::size_t nPermutations = c.n == 4 ? 24 : 120;
+            REQUIRE(counts.size() == nPermutations);
+            const double expected = static_cast<double>(nTrials) / nPermutations;
+            double chi2           = 0;
+            for (const auto & [permutation, count] : counts)
+            {
+                chi2 += (count - expected) * (count - expected) / expected;
+            }
+            const double dof = nPermutations - 1;
+            REQUIRE(chi2 < dof + 5 * std::sqrt(2 * dof));
+        }
+
+        // large ranges, over several uneven blocks
+        std::vector<sp::Uint32> values(5 * sp::details::shuffleBlockSize + 123);
+        std::iota(values.begin(), values.end(), 0u);
+        std::vector<sp::Uint32> sorted = values;
+
+        sp::Random::seed(21);
+        sp::RandList::shuffle(values);
+        std::vector<sp::Uint32> parallel = sorted;
+        sp::Random::seed(21);
+        sp::RandList::shuffle(parallel, sp::Execution::Parallel);
+        REQUIRE(parallel == values);
+
+        // elements of the first block end up everywhere
+        std::size_t fixed = 0;
+        double firstHalf  = 0;
+        for (std::size_t i = 0; i < values.size(); ++i)
+        {
+            fixed += values[i] == i;
+            firstHalf += values[i] < values.size() / 2 && i < values.size() / 2;
+        }
+        REQUIRE(fixed < 10);
+        REQUIRE(std::abs(firstHalf / values.size() - 0.25) < 0.01);
+
+        std::sort(values.begin(), values.end());
+        REQUIRE(values == sorted);
+
+        // permutations
+        std::vector<sp::Int32> order(3 * sp::details::shuffleBlockSize + 7);
+        sp::Random::seed(5);
+        sp::RandList::permutation(order, sp::Execution::Parallel);
+        std::vector<sp::Int32> replay(order.size());
+        sp::Random::seed(5);
+        sp::RandList::permutation(replay.begin(), replay.end());
+        REQUIRE(replay == order);
+
+        REQUIRE(order.front() != 0);
+        std::sort(order.begin(), order.end());
+        for (std::size_t i = 0; i < order.size(); ++i)
+        {
+            REQUIRE(order[i] == static_cast<sp::Int32>(i));
+        }
+
+        std::array<int, 3> positions{};
+        for (int t = 0; t < 3000; ++t)
+        {
+            std::array<sp::Uint8, 3> small;
+            sp::RandList::permutation(small);
+            ++positions[std::find(small.begin(), small.end(), 0) - small.begin()];
+        }
+        for (int count : positions)
+        {
+            REQUIRE(std::abs(count - 1000) < 150);
+        }
+    }
+
+    SECTION("Sampling without replacement")
+    {
+        // dense and sparse paths include every value with probability k / n
+        for (sp::Uint32 n : {12u, 100u})
+        {
+            std::vector<int> counts(n);
+            std::vector<sp::Uint32> sample(6);
+            const int nTrials = 10000;
+            for (int t = 0; t < nTrials; ++t)
+            {
+                sp::RandList::sampleWithoutReplacement(n, sample);
+                REQUIRE(std::set<sp::Uint32>(sample.begin(), sample.end()).size() == 6);
+                for (sp::Uint32 s : sample)
+                {
+                    REQUIRE(s < n);
+                    ++counts[s];
+                }
+            }
+
+            const double expected = 6. * nTrials / n;
+            for (int count : counts)
+            {
+                REQUIRE(std::abs(count - expected) < 0.15 * expected);
+            }
+        }
+
+        std::vector<sp::Uint64> sparse(1000);
+        sp::RandList::sampleWithoutReplacement<sp::Uint64>(sp::Uint64{1} << 40, sparse);
+        REQUIRE(std::set<sp::Uint64>(sparse.begin(), sparse.end()).size() == sparse.size());
+        REQUIRE(*std::max_element(sparse.begin(), sparse.end()) > (sp::Uint64{1} << 39));
+
+        std::list<int> all(7);
+        sp::RandList::sampleWithoutReplacement(7, all);
+        std::vector<int> sortedAll(all.begin(), all.end());
+        std::sort(sortedAll.begin(), sortedAll.end());
+        REQUIRE(sortedAll == std::vector<int>{0, 1, 2, 3, 4, 5, 6});
+    }
+
+    SECTION("Reservoir sampling")
+    {
+        std::vector<int> stream(100);
+        std::iota(stream.begin(), stream.end(), 0);
+        std::list<int> list(stream.begin(), stream.end());
+
+        // every item is kept with probability capacity / seen,
+        // one at a time, by random access ranges or by other ranges
+        for (int mode = 0; mode < 3; ++mode)
+        {
+            std::vector<int> counts(stream.size());
+            const int nTrials = 10000;
+            for (int t = 0; t < nTrials; ++t)
+            {
+                sp::ReservoirSampler<int> reservoir{10};
+                if (mode == 0)
+                {
+                    for (int item : stream)
+                    {
+                        reservoir.add(item);
+                    }
+                }
+                else if (mode == 1)
+                {
+                    reservoir.add(stream.begin(), stream.begin() + 37);
+                    reservoir.add(stream.begin() + 37, stream.end());
+                }
+                else
+                {
+                    reservoir.add(list.begin(), list.end());
+                }
+
+                REQUIRE(reservoir.seen() == 100);
+                REQUIRE(reservoir.sample().size() == 10);
+                for (int item : reservoir.sample())
+                {
+                    ++counts[item];
+                }
+            }
+
+            for (int count : counts)
+            {
+                REQUIRE(std::abs(count - 1000) < 200);
+            }
+        }
+
+        sp::ReservoirSampler<int> reservoir{50};
+        reservoir.add(stream.begin(), stream.begin() + 20);
+        REQUIRE(reservoir.sample().size() == 20);
+        REQUIRE(reservoir.capacity() == 50);
+
+        reservoir.clear();
+        REQUIRE(reservoir.seen() == 0);
+        REQUIRE(reservoir.sample().empty());
+
+        // long streams keep the late items as well
+        sp::Xoshiro256 engine{8};
+        std::vector<int> ids(1'000'000);
+        std::iota(ids.begin(), ids.end(), 0);
+        reservoir.add(engine, ids.begin(), ids.end());
+        REQUIRE(reservoir.seen() == ids.size());
+        int late = 0;
+        for (int id : reservoir.sample())
+        {
+            late += id >= 500'000;
+        }
+        REQUIRE(late > 10);
+        REQUIRE(late < 40);
+    }
+}
@@ -0,0 +1,218 @@
+#include "SPIRIT/Math/Random/Random.hpp"
+#include "SPIRIT/Math/Random/Sequence.hpp"
+#include "catch2/catch_test_macros.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <list>
+#include <vector>
+
+
+// Every elementary interval of [0, 1)^2 of volume 1 / n
+// (2^a by 2^(m - a) cells) holds exactly one of the n = 2^m points.
+bool
+isNet(const std::vector<sp::Vec2> & points)
+{
+    sp::Int32 m = 0;
+    while ((std::size_t{1} << m) < points.size())
+    {
+        ++m;
+    }
+
+    for (sp::Int32 a = 0; a <= m; ++a)
+    {
+        sp::Int32 nx = 1 << a;
+        sp::Int32 ny = 1 << (m - a);
+        std::vector<int> counts(points.size(), 0);
+        for (const sp::Vec2 & p : points)
+        {
+            sp::Int32 cx = static_cast<sp::Int32>(p[0] * nx);
+            sp::Int32 cy = static_cast<sp::Int32>(p[1] * ny);
+            ++counts[cx * ny + cy];
+        }
+
+        if (!std::all_of(counts.begin(), counts.end(), [](int c) { return c == 1; }))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+TEST_CASE("Sequence")
+{
+    SECTION("Sobol")
+    {
+        sp::SobolSequence<2> sobol{};
+        REQUIRE(sobol() == sp::Vec2{0.f, 0.f});
+        REQUIRE(sobol() == sp::Vec2{0.5f, 0.5f});
+        REQUIRE(sobol() == sp::Vec2{0.75f, 0.25f});
+        REQUIRE(sobol() == sp::Vec2{0.25f, 0.75f});
+        REQUIRE(sobol.index() == 4);
+
+        for (sp::Scrambling scrambling :
+             {sp::Scrambling::None, sp::Scrambling::RandomDigit, sp::Scrambling::Owen})
+        {
+            sp::SobolSequence<2> sequence{scrambling, 42};
+            std::vector<sp::Vec2> points(256);
+            sequence.fill(std::span{points});
+            REQUIRE(isNet(points));
+
+            // the next 256 points are a net as well
+            sequence.fill(std::span{points});
+            REQUIRE(isNet(points));
+        }
+
+        // every pair of dimensions
+        sp::SobolSequence<8> sobol8{};
+        std::vector<sp::Vector<float, 8>> points(64);
+        sobol8.fill(std::span{points});
+        for (sp::Int32 i = 0; i < 8; ++i)
+        {
+            std::vector<float> values(points.size());
+            for (std::size_t p = 0; p < points.size(); ++p)
+            {
+                values[p] = points[p][i];
+            }
+
+            // each dimension is a permutation of k / 64
+            std::sort(values.begin(), values.end());
+            for (std::size_t p = 0; p < points.size(); ++p)
+            {
+                REQUIRE(values[p] == p / 64.f);
+            }
+        }
+
+        sp::SobolSequence<3> owen{sp::Scrambling::Owen, 1};
+        sp::SobolSequence<3> otherOwen{sp::Scrambling::Owen, 2};
+        REQUIRE(owen.point(5) != otherOwen.point(5));
+    }
+
+    SECTION("Halton")
+    {
+        sp::HaltonSequence<3> halton{};
+        REQUIRE(halton.base(2) == 5);
+
+        auto isClose = [](sp::Vector<double, 3> a, sp::Vector<double, 3> b) {
+            return (a - b).norm() < 1e-12;
+        };
+        REQUIRE(isClose(halton.point<double>(0), {0, 0, 0}));
+        REQUIRE(isClose(halton.point<double>(1), {1 / 2., 1 / 3., 1 / 5.}));
+        REQUIRE(isClose(halton.point<double>(2), {1 / 4., 2 / 3., 2 / 5.}));
+        REQUIRE(isClose(halton.point<double>(3), {3 / 4., 1 / 9., 3 / 5.}));
+        REQUIRE(isClose(halton.point<double>(6), {3 / 8., 2 / 9., 6 / 25.}));
+
+        // the first 3^k values of base 3 stratify [0, 1) in 3^k intervals,
+        // scrambled or not
+        for (sp::Scrambling scrambling :
+             {sp::Scrambling::None, sp::Scrambling::RandomDigit, sp::Scrambling::Owen})
+        {
+            sp::HaltonSequence<2> sequence{scrambling, 7};
+            std::vector<int> counts(81, 0);
+            for (int i = 0; i < 81; ++i)
+            {
+                // unscrambled values are k / 81, rounded down
+                sp::Vector<double, 2> p = sequence.point<double>(i);
+                REQUIRE((p[0] >= 0 && p[0] < 1 && p[1] >= 0 && p[1] < 1));
+                ++counts[static_cast<int>(p[1] * 81 + 1e-9)];
+            }
+            REQUIRE(std::all_of(counts.begin(), counts.end(), [](int c) { return c == 1; }));
+        }
+
+        // every dimension is scrambled, including base 2 and the trailing zeros
+        sp::HaltonSequence<8> plain{};
+        for (sp::Scrambling scrambling : {sp::Scrambling::RandomDigit, sp::Scrambling::Owen})
+        {
+            for (sp::Uint64 seed : {0, 1, 2, 3, 42})
+            {
+                sp::HaltonSequence<8> scrambled{scrambling, seed};
+                for (sp::Int32 d = 0; d < 8; ++d)
+                {
+                    REQUIRE(scrambled.point<double>(0)[d] != 0);
+
+                    bool differs = true;
+                    for (sp::Uint64 i = 1; i < 16; ++i)
+                    {
+                        differs = differs
+                                  && scrambled.point<double>(i)[d] != plain.point<double>(i)[d];
+                    }
+                    REQUIRE(differs);
+                }
+            }
+        }
+    }
+
+    SECTION("R2")
+    {
+        sp::R2Sequence<2> r2{};
+        double phi = 1.32471795724474602596;
+        for (sp::Uint64 n : {0, 1, 2, 1000, 123456789})
+        {
+            sp::Vector<double, 2> p = r2.point<double>(n);
+            double x = std::fmod(0.5 + n / phi, 1.0);
+            double y = std::fmod(0.5 + n / (phi * phi), 1.0);
+            REQUIRE(std::abs(p[0] - x) < 1e-6);
+            REQUIRE(std::abs(p[1] - y) < 1e-6);
+        }
+
+        sp::R2Sequence<2> shifted{sp::Scrambling::RandomDigit, 3};
+        sp::Vec2 d0 = shifted.point(0) - r2.point(0);
+        sp::Vec2 d1 = shifted.point(10) - r2.point(10);
+        for (sp::Int32 i = 0; i < 2; ++i)
+        {
+            // same toroidal shift for every point
+            float diff = std::abs(d0[i] - d1[i]);
+            REQUIRE(std::min(diff, 1 - diff) < 1e-5f);
+        }
+    }
+
+    SECTION("Bulk fills")
+    {
+        auto testFills = []<class Sequence>(Sequence sequence) {
+            constexpr sp::Int32 dim = Sequence::dimension;
+            std::vector<sp::Vector<float, dim>> expected(100000);
+            for (auto & p : expected)
+            {
+                p = sequence();
+            }
+
+            // from an index, split across threads
+            std::vector<sp::Vector<float, dim>> points(expected.size() - 100);
+            sequence.seek(100);
+            sequence.fill(std::span{points}, sp::Execution::Parallel);
+            REQUIRE(std::equal(points.begin(), points.end(), expected.begin() + 100));
+            REQUIRE(sequence.index() == expected.size());
+
+            // interleaved coordinates
+            std::vector<float> values(3 * dim);
+            sequence.seek(5);
+            sp::RandList::quasiRandom(sequence, values);
+            for (sp::Int32 i = 0; i < 3 * dim; ++i)
+            {
+                REQUIRE(values[i] == expected[5 + i / dim][i % dim]);
+            }
+
+            // non contiguous ranges
+            std::list<sp::Vector<float, dim>> list(4);
+            sequence.seek(7);
+            sp::RandList::quasiRandom(sequence, list);
+            REQUIRE(std::equal(list.begin(), list.end(), expected.begin() + 7));
+
+            std::list<float> coordinates(2 * dim);
+            sequence.seek(9);
+            sp::RandList::quasiRandom(sequence, coordinates);
+            auto it = coordinates.begin();
+            for (sp::Int32 i = 0; i < 2 * dim; ++i, ++it)
+            {
+                REQUIRE(*it == expected[9 + i / dim][i % dim]);
+            }
+        };
+
+        testFills(sp::SobolSequence<3>{sp::Scrambling::Owen, 5});
+        testFills(sp::HaltonSequence<2>{sp::Scrambling::RandomDigit, 5});
+        testFills(sp::R2Sequence<3>{});
+        testFills(sp::SobolSequence<1>{});
+    }
+}
@@ -0,0 +1,152 @@
+#include "SPIRIT/Math/Stream/Stream.hpp"
+#include "catch2/catch_test_macros.hpp"
+
+
+TEST_CASE("Streams")
+{
+    // not a multiple of the batch size, the padding is exercised
+    constexpr std::size_t n = 37;
+
+    std::vector<sp::Vec3> a{};
+    std::vector<sp::Vec3> b{};
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        float f = static_cast<float>(i);
+        a.push_back(sp::Vec3{f, 1 - f, 2 * f});
+        b.push_back(sp::Vec3{3 - f, f / 2, 1});
+    }
+
+    sp::Vec3Stream as{a.begin(), a.end()};
+    sp::Vec3Stream bs{b.begin(), b.end()};
+
+    SECTION("Construction and access")
+    {
+        REQUIRE(as.size() == n);
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            REQUIRE(as[i] == a[i]);
+        }
+
+        as.set(3, sp::Vec3{7, 8, 9});
+        REQUIRE(as[3] == sp::Vec3{7, 8, 9});
+        REQUIRE(as.lane(1)[3] == 8);
+
+        sp::Vec3Stream zeros{n};
+        REQUIRE(zeros[n - 1] == sp::Vec3::Zero());
+
+        as.resize(2);
+        as.resize(n);
+        REQUIRE(as[2] == sp::Vec3::Zero());
+    }
+
+    SECTION("Component wise operations")
+    {
+        sp::Vec3Stream sum  = as + bs;
+        sp::Vec3Stream diff = as - bs;
+        sp::Vec3Stream scaled = 2.f * as;
+
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            REQUIRE(sum[i] == a[i] + b[i]);
+            REQUIRE(diff[i] == a[i] - b[i]);
+            REQUIRE(scaled[i] == a[i] * 2.f);
+        }
+    }
+
+    SECTION("Vector operations")
+    {
+        sp::VecStream<float, 1> dots  = as.dot(bs);
+        sp::VecStream<float, 1> norms = as.norm();
+        sp::Vec3Stream crosses        = as.cross(bs);
+
+        as.set(0, sp::Vec3::Zero());
+        sp::Vec3Stream normalized = as.normalized();
+        REQUIRE(normalized[0] == sp::Vec3::Zero());
+
+        for (std::size_t i = 1; i < n; ++i)
+        {
+            REQUIRE(sp::Vec<1>{dots[i][0]}.isApprox(sp::Vec<1>{a[i].dot(b[i])}));
+            REQUIRE(sp::Vec<1>{norms[i][0]}.isApprox(sp::Vec<1>{a[i].norm()}));
+            sp::Vec3 cross{
+                a[i][1] * b[i][2] - a[i][2] * b[i][1],
+                a[i][2] * b[i][0] - a[i][0] * b[i][2],
+                a[i][0] * b[i][1] - a[i][1] * b[i][0]};
+            REQUIRE(crosses[i].isApprox(cross));
+            REQUIRE(normalized[i].isApprox(a[i].normalized()));
+        }
+
+        sp::Vec2Stream xy{sp::Vec2{1, 0}, sp::Vec2{2, 3}};
+        sp::Vec2Stream yx{sp::Vec2{0, 1}, sp::Vec2{3, 2}};
+        sp::VecStream<float, 1> z = xy.cross(yx);
+        REQUIRE(z[0][0] == 1);
+        REQUIRE(z[1][0] == -5);
+    }
+
+    SECTION("Matrix products")
+    {
+        sp::Mat3 m{
+            {1, 2, 3},
+            {4, 5, 6},
+            {7, 8, 9}
+        };
+
+        sp::Vec3Stream uniform = m * as;
+
+        sp::Mat3Stream ms{};
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            ms.push_back(m * static_cast<float>(i));
+        }
+        sp::Vec3Stream perElement = ms * as;
+
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            REQUIRE(uniform[i].isApprox(m * a[i]));
+            REQUIRE(perElement[i].isApprox(m * static_cast<float>(i) * a[i]));
+        }
+    }
+
+    SECTION("Determinants and inverses")
+    {
+        auto check = [](auto stream) {
+            typedef typename decltype(stream)::value_type Mat;
+
+            for (int i = 0; i < 37; ++i)
+            {
+                // every 5th matrix is singular
+                Mat m = Mat::Random();
+                if (i % 5 == 0)
+                {
+                    m = m * Mat::Zero();
+                }
+                stream.push_back(m);
+            }
+
+            sp::VecStream<float, 1> dets = stream.determinant();
+            std::vector<bool> wasInversed;
+            auto inverses = stream.inversed(wasInversed);
+            REQUIRE(wasInversed.size() == stream.size());
+
+            for (std::size_t i = 0; i < stream.size(); ++i)
+            {
+                REQUIRE(std::abs(dets[i][0] - stream[i].determinant()) < 1e-4f);
+
+                bool expected;
+                Mat inv = stream[i].inversed(expected);
+                REQUIRE(wasInversed[i] == expected);
+                if (expected)
+                {
+                    REQUIRE(inverses[i].isApprox(inv, 1e-3f));
+                }
+                else
+                {
+                    REQUIRE(inverses[i] == stream[i]);
+                }
+            }
+        };
+
+        check(sp::Mat2Stream{});
+        check(sp::Mat3Stream{});
+        check(sp::Mat4Stream{});
+    }
+}
@@ -1,6 +1,10 @@
+#include "SPIRIT/Math/Transform/Hierarchy.hpp"
+#include "SPIRIT/Math/Transform/TRS.hpp"
 #include "SPIRIT/Math/Transform/Transform.hpp"
 #include "catch2/catch_test_macros.hpp"
 
+#include <cmath>
+
 
 TEST_CASE("Transformations")
 {
@@ -66,4 +70,325 @@ TEST_CASE("Transformations")
         t.inverse();
         REQUIRE(inv == t);
     }
+
+    SECTION("Compact storage")
+    {
+        static_assert(sizeof(sp::CompactTransform3D) == 12 * sizeof(float));
+        static_assert(sizeof(sp::Transform3D) == 16 * sizeof(float));
+
+        sp::Transform3D t{};
+        t.translate({1, 2, 3})
+            .rotate(sp::radians(30.f), sp::Vec3{1, 0, 0})
+            .scale(sp::Vec3{1, 2, 3})
+            .translate({3, 2, 1});
+
+        sp::CompactTransform3D c{t};
+        REQUIRE(c.toMatrix() == t.toMatrix());
+        REQUIRE(sp::Transform3D{c} == t);
+        REQUIRE(sp::CompactTransform3D{t.toMatrix()} == c);
+
+        sp::Vec3 p{5, 6, 4};
+        REQUIRE((c * p).isApprox(t * p));
+        REQUIRE((c * c).toMatrix().isApprox((t * t).toMatrix()));
+        REQUIRE((c * t).toMatrix().isApprox((t * t).toMatrix()));
+        REQUIRE(c.inversed().toMatrix().isApprox(t.inversed().toMatrix()));
+        REQUIRE((c.inversed() * (c * p)).isApprox(p));
+
+        sp::CompactTransform3D composed = c;
+        composed.transform(c);
+        REQUIRE(composed.isApprox(c * c));
+
+        std::vector<sp::Vec3> points(45, p);
+        c.applyTo(points, points);
+        REQUIRE(points.back().isApprox(t * p));
+
+        // not tracked
+        sp::CompactTransform3D rigid{sp::Transform3D{}.translate({1, 2, 3})};
+        REQUIRE(rigid.transformClass() == sp::TransformClass::Affine);
+        REQUIRE(sp::Transform3D{rigid}.transformClass() == sp::TransformClass::Affine);
+        REQUIRE((rigid.inversed() * (rigid * p)).isApprox(p));
+    }
+
+    SECTION("Transform classes")
+    {
+        sp::Transform3D rigid{};
+        rigid.translate({1, 2, 3}).rotate(sp::radians(30.f), sp::Vec3{0, 1, 0});
+        REQUIRE(rigid.transformClass() == sp::TransformClass::Isometry);
+
+        sp::Transform3D scaled = rigid;
+        scaled.scale(2).translate({1, 0, 0});
+        REQUIRE(scaled.transformClass() == sp::TransformClass::UniformScale);
+        REQUIRE(sp::Transform3D{scaled}.scale(sp::Vec3{3, 3, 3}).transformClass()
+                == sp::TransformClass::UniformScale);
+
+        sp::Transform3D general = rigid;
+        general.scale(sp::Vec3{1, 2, 3});
+        REQUIRE(general.transformClass() == sp::TransformClass::Affine);
+        REQUIRE(sp::Transform3D{rigid.toMatrix()}.transformClass()
+                == sp::TransformClass::Affine);
+
+        sp::Transform2D sheared{};
+        sheared.translate({1, 0}).shear(2, 0);
+        REQUIRE(sheared.transformClass() == sp::TransformClass::Affine);
+        REQUIRE((sheared * sp::Vec2{0, 1}).isApprox(sp::Vec2{3, 1}));
+
+        REQUIRE((rigid * rigid).transformClass() == sp::TransformClass::Isometry);
+        REQUIRE((rigid * scaled).transformClass() == sp::TransformClass::UniformScale);
+        REQUIRE((scaled * general).transformClass() == sp::TransformClass::Affine);
+
+        // kept in the last row, which is not part of the matrix
+        sp::Mat4 matrix = scaled.toMatrix();
+        REQUIRE(matrix(3, 0) == 0);
+        REQUIRE(matrix(3, 3) == 1);
+        REQUIRE(sp::Transform3D{scaled} == scaled);
+        REQUIRE(sp::Transform3D{scaled}.inverse().inverse().transformClass()
+                == sp::TransformClass::UniformScale);
+        REQUIRE(sp::Transform3D{sp::CompactTransform3D{scaled}} == scaled);
+
+        sp::Vec3 p{5, 6, 4};
+        for (const sp::Transform3D & t : {rigid, scaled, general})
+        {
+            sp::Transform3D inv = t.inversed();
+            REQUIRE(inv.transformClass() == t.transformClass());
+            REQUIRE((inv * (t * p)).isApprox(p));
+
+            bool wasInversed;
+            REQUIRE(inv.toMatrix().isApprox(t.toMatrix().inversed(wasInversed)));
+
+            sp::Mat3 normal   = t.normalMatrix();
+            sp::Mat3 expected = t.linear().inversed(wasInversed).transposed();
+            if (t.transformClass() != sp::TransformClass::Affine)
+            {
+                // same direction, unit length kept
+                sp::Vec3 n = normal * sp::Vec3{0, 0, 1};
+                REQUIRE(std::abs(n.norm() - 1) < 1e-5f);
+                REQUIRE(n.isApprox((expected * sp::Vec3{0, 0, 1}).normalized()));
+            }
+            else
+            {
+                REQUIRE(normal.isApprox(expected));
+            }
+
+            std::vector<sp::Vec3> normals(45, sp::Vec3{0, 0, 1});
+            t.applyNormalTo(normals, normals);
+            REQUIRE(normals.back().isApprox(normal * sp::Vec3{0, 0, 1}));
+        }
+    }
+
+    SECTION("Bulk application")
+    {
+        sp::Transform3D t{};
+        t.translate({1, 2, 3})
+            .rotate(sp::radians(30.f), sp::Vec3{0, 0, 1})
+            .scale(2);
+
+        std::vector<sp::Vec3> points{};
+        for (int i = 0; i < 45; ++i)
+        {
+            points.push_back(sp::Vec3{float(i), float(2 * i), float(-i)});
+        }
+
+        std::vector<sp::Vec3> res(points.size());
+        t.applyTo(points, res);
+        for (std::size_t i = 0; i < points.size(); ++i)
+        {
+            REQUIRE(res[i].isApprox(t * points[i]));
+        }
+
+        t.applyLinearTo(points, res);
+        for (std::size_t i = 0; i < points.size(); ++i)
+        {
+            REQUIRE(res[i].isApprox(t.linear() * points[i]));
+        }
+
+        sp::Vec3Stream stream{points.begin(), points.end()};
+        sp::Vec3Stream transformed = t.applyTo(stream);
+        for (std::size_t i = 0; i < points.size(); ++i)
+        {
+            REQUIRE(transformed[i].isApprox(t * points[i]));
+        }
+
+        // in place and across threads
+        std::vector<sp::Vec3> many(200000, sp::Vec3{1, 1, 1});
+        t.applyTo(many, many, sp::Execution::Parallel);
+        REQUIRE(many.front().isApprox(t * sp::Vec3{1, 1, 1}));
+        REQUIRE(many.back().isApprox(t * sp::Vec3{1, 1, 1}));
+
+        // entry points of the runtime dispatch, see Dispatch.hpp
+        sp::details::Kernels kernels = sp::details::makeKernels<xsimd::default_arch>();
+        const float affine[12] = {1, 0, 0, 0, 2, 0, 0, 0, 3, 1, 2, 3};
+
+        std::vector<float> packed(3 * 45, 1.f);
+        kernels.transformFloat3.packed(affine, packed.data(), packed.data(), 45, true);
+        REQUIRE(packed[3 * 44 + 2] == 6.f);
+
+        std::vector<float> x(45, 1.f), y(45, 1.f), z(45, 1.f);
+        const float * src[3] = {x.data(), y.data(), z.data()};
+        float * dst[3]       = {x.data(), y.data(), z.data()};
+        kernels.transformFloat3.split(affine, src, dst, 45, false);
+        REQUIRE(y.back() == 2.f);
+        REQUIRE(z.back() == 3.f);
+    }
+    SECTION("TRS")
+    {
+        sp::Quat q{sp::radians(30.f), sp::Vec3{0, 0, 1}};
+
+        sp::TRSTransform trs{sp::Vec3{1, 2, 3}, q, sp::Vec3{1, 2, 3}};
+        sp::Transform3D t{};
+        t.scale(sp::Vec3{1, 2, 3}).rotate(q).translate({1, 2, 3});
+        REQUIRE(trs.toTransformation().isApprox(t));
+
+        sp::Vec3 p{5, 6, 4};
+        REQUIRE((trs * p).isApprox(t * p));
+
+        // operations in call order, uniform scale after the rotation
+        sp::TRSTransform ops{};
+        ops.rotate(q).translate({1, 0, 0}).scale(2);
+        t = sp::Transform3D{};
+        t.rotate(q).translate({1, 0, 0}).scale(2);
+        REQUIRE((ops * p).isApprox(t * p));
+
+        sp::TRSTransform other{sp::Vec3{-1, 0, 2}, sp::Quat{0.5f, sp::Vec3{1, 0, 0}}, sp::Vec3{3, 3, 3}};
+        REQUIRE(((other * trs) * p).isApprox(other * (trs * p)));
+        REQUIRE((other.inversed() * (other * p)).isApprox(p));
+
+        std::vector<sp::Vec3> points{};
+        for (int i = 0; i < 45; ++i)
+        {
+            points.push_back(sp::Vec3{float(i), float(2 * i), float(-i)});
+        }
+
+        std::vector<sp::Vec3> res(points.size());
+        trs.applyTo(points, res);
+        for (std::size_t i = 0; i < points.size(); ++i)
+        {
+            REQUIRE(res[i].isApprox(trs * points[i]));
+        }
+    }
+
+    SECTION("Hierarchy")
+    {
+        sp::TransformHierarchy3D tree{};
+
+        // a root with a chain and a fan of children
+        auto root  = tree.add(sp::Transform3D{}.translate({1, 0, 0}));
+        auto chain = root;
+        std::vector<sp::TransformHierarchy3D::Node> chainNodes{};
+        for (int i = 0; i < 5; ++i)
+        {
+            chain = tree.add(
+                sp::Transform3D{}.rotate(sp::radians(10.f), sp::Vec3{0, 0, 1}).translate({0, 1, 0}),
+                chain
+            );
+            chainNodes.push_back(chain);
+        }
+
+        std::vector<sp::TransformHierarchy3D::Node> fan{};
+        for (int i = 0; i < 37; ++i)
+        {
+            fan.push_back(tree.add(sp::Transform3D{}.scale(1 + 0.1f * i), root));
+        }
+
+        auto expectedWorld = [&](sp::TransformHierarchy3D::Node node) {
+            sp::Transform3D world = tree.local(node);
+            for (auto p = tree.parent(node); p != tree.noParent; p = tree.parent(p))
+            {
+                world = tree.local(p) * world;
+            }
+            return world;
+        };
+
+        auto checkAll = [&]() {
+            for (sp::TransformHierarchy3D::Node node = 0; node < tree.size(); ++node)
+            {
+                REQUIRE(tree.world(node).isApprox(expectedWorld(node)));
+                REQUIRE(tree.world(node).transformClass() == expectedWorld(node).transformClass());
+            }
+        };
+
+        REQUIRE(tree.update() == std::size_t(tree.size()));
+        checkAll();
+        REQUIRE(tree.update() == 0);
+
+        // only the subtree is recomputed
+        tree.setLocal(chainNodes[2], sp::Transform3D{}.translate({0, 0, 2}));
+        REQUIRE(tree.update() == 3);
+        checkAll();
+
+        tree.setLocal(root, sp::Transform3D{}.rotate(sp::radians(45.f), sp::Vec3{1, 0, 0}));
+        REQUIRE(tree.update(sp::Execution::Parallel) == std::size_t(tree.size()));
+        checkAll();
+        REQUIRE(tree.depth(chainNodes.back()) == 5);
+
+        sp::TransformationHierarchy<float, 3, sp::TransformStorage::AffineCompact> compact{};
+        auto compactRoot = compact.add(sp::CompactTransform3D{tree.local(root)});
+        for (auto node : fan)
+        {
+            compact.add(sp::CompactTransform3D{tree.local(node)}, compactRoot);
+        }
+        compact.update();
+        for (std::size_t i = 0; i < fan.size(); ++i)
+        {
+            REQUIRE(compact.world(static_cast<sp::Int32>(i + 1)).toMatrix().isApprox(
+                tree.world(fan[i]).toMatrix()
+            ));
+        }
+    }
+
+    SECTION("Parallel hierarchy")
+    {
+        // enough nodes to be split among threads, with nRoots independent subtrees
+        auto build = [](int nRoots, int nChildren) {
+            sp::TransformHierarchy3D tree{};
+            for (int r = 0; r < nRoots; ++r)
+            {
+                auto root = tree.add(sp::Transform3D{}.translate({float(r), 0, 0}));
+                for (int c = 0; c < nChildren; ++c)
+                {
+                    auto child = tree.add(
+                        sp::Transform3D{}.rotate(sp::radians(float(c)), sp::Vec3{0, 0, 1}),
+                        root
+                    );
+                    for (int g = 0; g < 10; ++g)
+                    {
+                        tree.add(sp::Transform3D{}.translate({0, float(g), 0}).scale(2), child);
+                    }
+                }
+            }
+
+            return tree;
+        };
+
+        auto checkSame = [](const sp::TransformHierarchy3D & tree,
+                            const sp::TransformHierarchy3D & expected) {
+            for (sp::TransformHierarchy3D::Node node = 0; node < tree.size(); ++node)
+            {
+                REQUIRE(tree.world(node).isApprox(expected.world(node)));
+                REQUIRE(tree.world(node).transformClass() == expected.world(node).transformClass());
+            }
+        };
+
+        // split by subtree
+        sp::TransformHierarchy3D forest   = build(64, 10);
+        sp::TransformHierarchy3D expected = build(64, 10);
+        REQUIRE(forest.update(sp::Execution::Parallel) == std::size_t(forest.size()));
+        expected.update();
+        checkSame(forest, expected);
+
+        for (sp::TransformHierarchy3D::Node root = 0; root < forest.size(); root += 111 * 3)
+        {
+            auto moved = sp::Transform3D{}.rotate(sp::radians(30.f), sp::Vec3{1, 0, 0});
+            forest.setLocal(root, moved);
+            expected.setLocal(root, moved);
+        }
+        REQUIRE(forest.update(sp::Execution::Parallel) == expected.update());
+        checkSame(forest, expected);
+
+        // a single subtree, split by depth
+        sp::TransformHierarchy3D tree = build(1, 600);
+        expected                      = build(1, 600);
+        REQUIRE(tree.update(sp::Execution::Parallel) == std::size_t(tree.size()));
+        expected.update();
+        checkSame(tree, expected);
+    }
 }